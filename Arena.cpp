@@ -3,89 +3,398 @@
 #include <chrono>
 #include <thread>
 #include <algorithm>
+#include <limits>
+#include <tuple>
+#include <array>
+#include <utility>
+#include <new>
+
+// Runs one call into robot code with its allocations routed to the robot's
+// heap. False if the call ran out of its memory budget: the heap refused an
+// allocation and the robot let the std::bad_alloc escape.
+template <typename Fn>
+static bool robot_call(RobotEntry& e, Fn&& fn) {
+    RobotHeap::Scope scope(e.heap.get());
+    try {
+        fn();
+        return true;
+    } catch (const std::bad_alloc&) {
+        ++e.memoryBreaches;
+        return false;
+    }
+}
+
+// Runs one robot call against the configured CPU and memory budgets. Returns
+// false if the call went over the per-call budget, used up the match budget
+// or ran out of memory. The CPU budgets are settled after the call returns;
+// nothing here interrupts one that does not (see GameConfig::callBudgetUs).
+template <typename Fn>
+bool Arena::budgeted_call(RobotEntry& e, Fn&& fn) {
+    if (cfg.callBudgetUs <= 0 && cfg.matchBudgetUs <= 0) {
+        if (!cfg.timeRobots) return robot_call(e, fn);
+        long long t0 = ThreadCpuClock::now_ns();
+        bool ok = robot_call(e, fn);
+        e.cpuNs += ThreadCpuClock::now_ns() - t0;
+        return ok;
+    }
+
+    long long limit = std::numeric_limits<long long>::max();
+    if (cfg.callBudgetUs > 0) limit = cfg.callBudgetUs * 1000;
+    if (cfg.matchBudgetUs > 0) limit = std::min(limit, cfg.matchBudgetUs * 1000 - e.cpuNs);
+
+    long long t0 = ThreadCpuClock::now_ns();
+    bool ok = robot_call(e, fn);
+    long long ns = ThreadCpuClock::now_ns() - t0;
+    e.cpuNs += ns;
+    if (ns <= limit) return ok;
+    ++e.budgetBreaches;
+    return false;
+}
 
 Arena::Arena(const GameConfig& cfg_in)
-    : cfg(cfg_in), board(cfg_in.height, cfg_in.width), rng(cfg_in.rngSeed) {}
+    : cfg(cfg_in), board(cfg_in.height, cfg_in.width), rng(cfg_in.rngSeed),
+      tile_robots(static_cast<size_t>(board.tile_rows()) * board.tile_cols()),
+      radar_scan(radar_for_size(board.rows(), board.cols())) {
+    if (cfg.mapPath.empty()) return;
+    map = GameMap::shared(cfg.mapPath);
+    if (!map) {
+        std::cerr << "Using random obstacles instead of " << cfg.mapPath << "\n";
+        return;
+    }
+    cfg.height = map->rows();
+    cfg.width = map->cols();
+    board = map->board();
+    tile_robots.assign(static_cast<size_t>(board.tile_rows()) * board.tile_cols(), {});
+    radar_scan = radar_for_size(board.rows(), board.cols());
+}
+
+// FNV-1a over the settings that change how a match plays out; seed, display
+// and thread count are left out so equal rules hash equal
+uint64_t config_hash(const GameConfig& cfg) {
+    uint64_t h = 1469598103934665603ULL;
+    auto mix = [&](long long v) {
+        for (int i = 0; i < 8; ++i) {
+            h ^= static_cast<uint64_t>(v >> (8 * i)) & 0xff;
+            h *= 1099511628211ULL;
+        }
+    };
+    mix(cfg.width);
+    mix(cfg.height);
+    mix(cfg.mounds);
+    mix(cfg.pits);
+    mix(cfg.flamers);
+    mix(cfg.maxRounds);
+    mix(cfg.robotCopies);
+    mix(cfg.simultaneousTurns);
+    mix(cfg.callBudgetUs);
+    mix(cfg.matchBudgetUs);
+    mix(cfg.memoryBudgetKb);
+    mix(cfg.stalemateRounds);
+    for (const auto& w : cfg.rules.weapons) {
+        mix(w.minDamage);
+        mix(w.maxDamage);
+        mix(static_cast<int>(w.shape));
+        mix(w.range);
+        mix(w.ammo);
+    }
+    for (const CellRule* c : {&cfg.rules.mound, &cfg.rules.flamethrower, &cfg.rules.pit}) {
+        mix(c->blocks);
+        mix(c->traps);
+        mix(c->minDamage);
+        mix(c->maxDamage);
+    }
+    mix(cfg.rules.armorLossPerHit);
+    if (!cfg.mapPath.empty()) {
+        if (auto map = GameMap::shared(cfg.mapPath)) mix(static_cast<long long>(map->hash()));
+    }
+    return h;
+}
+
+const char* end_reason_name(EndReason reason) {
+    switch (reason) {
+        case EndReason::winner: return "winner";
+        case EndReason::max_rounds: return "max rounds";
+        case EndReason::repeated_state: return "repeated state";
+        case EndReason::unreachable: return "unreachable";
+        default: return "none";
+    }
+}
+
+// Board and action printout; a quiet arena (tournament matches) discards it
+// into its own stream, so arenas on other threads share no stream state
+std::ostream& Arena::out() {
+    return cfg.quiet ? discard : std::cout;
+}
 
 char Arena::next_glyph() {
     static const std::string glyphs = "@$#!&%?";
-    static size_t i = 0;
-    return glyphs[i++ % glyphs.size()];
+    return glyphs[glyph_counter++ % glyphs.size()];
 }
 
+void Arena::collect_free_cells() {
+    free_cells.clear();
+    for (int r = 0; r < board.rows(); ++r) {
+        for (int c = 0; c < board.cols(); ++c) {
+            if (board.at(r, c).type == '.') free_cells.push_back(board.index(r, c));
+        }
+    }
+    free_cells_listed = true;
+}
+
+// A few uniform draws first: on a sparse board they almost always land on an
+// empty cell without listing millions of free ones. After that, partial
+// Fisher-Yates over the free list: pick a random slot, swap it to the back and
+// pop it, so every draw is O(1) and an exhausted board fails at once.
 std::pair<int,int> Arena::random_empty_cell() {
-    std::uniform_int_distribution<int> rdist(0, cfg.height - 1);
-    std::uniform_int_distribution<int> cdist(0, cfg.width - 1);
-    for (int tries = 0; tries < 10000; ++tries) {
-        int r = rdist(rng), c = cdist(rng);
+#ifdef ROBOTWARZ_REFERENCE_ENGINE
+    if (cfg.referenceEngine) return reference_empty_cell();
+#endif
+    if (!free_cells_listed) {
+        std::uniform_int_distribution<int> row(0, board.rows() - 1), col(0, board.cols() - 1);
+        for (int tries = 0; tries < 16; ++tries) {
+            int r = row(rng), c = col(rng);
+            if (board.at(r, c).type == '.') return {r, c};
+        }
+        collect_free_cells();
+    }
+
+    while (!free_cells.empty()) {
+        std::uniform_int_distribution<size_t> pick(0, free_cells.size() - 1);
+        size_t j = pick(rng);
+        int idx = free_cells[j];
+        free_cells[j] = free_cells.back();
+        free_cells.pop_back();
+
+        int r = board.row_of(idx), c = board.col_of(idx);
         if (board.at(r, c).type == '.') return {r, c};
     }
     return {-1, -1};
 }
 
-bool Arena::is_cell_free_for_robot(int r, int c) const {
-    if (!board.in_bounds(r, c)) return false;
-    char t = board.at(r, c).type;
-    return t == '.';
+// Moves a robot's arena-side position and keeps tile_robots in step
+void Arena::set_robot_position(int robotIdx, int r, int c) {
+    auto& e = robots[robotIdx];
+    if (board.in_bounds(e.row, e.col) && board.in_bounds(r, c) && board.tile_of(e.row, e.col) == board.tile_of(r, c)) {
+        e.row = r; e.col = c;
+        return;
+    }
+    if (board.in_bounds(e.row, e.col)) {
+        auto& from = tile_robots[board.tile_of(e.row, e.col)];
+        auto it = std::find(from.begin(), from.end(), robotIdx);
+        if (it != from.end()) { *it = from.back(); from.pop_back(); }
+    }
+    e.row = r; e.col = c;
+    if (board.in_bounds(r, c)) tile_robots[board.tile_of(r, c)].push_back(robotIdx);
 }
 
-bool Arena::load_robots_from_sources(const std::string& directory) {
-    // Compile and load Robot_*.cpp from directory
-    bool anyLoaded = false;
-    for (auto& p : std::filesystem::directory_iterator(directory)) {
-        if (!p.is_regular_file()) continue;
-        auto name = p.path().filename().string();
-        if (name.rfind("Robot_", 0) != 0 || p.path().extension() != ".cpp") continue;
-
-        std::string so = "./lib" + p.path().stem().string() + ".so";
-        std::string cmd = "g++ -shared -fPIC -o " + so + " " + p.path().string() + " RobotBase.o -I. -std=c++20";
-        std::cout << "Compiling " << name << " -> " << so << "\n";
-        if (std::system(cmd.c_str()) != 0) {
-            std::cerr << "Compile failed: " << name << "\n";
-            continue;
+void Arena::rebuild_robot_index() {
+    for (auto& list : tile_robots) list.clear();
+    for (size_t i = 0; i < robots.size(); ++i) {
+        const auto& e = robots[i];
+        if (board.in_bounds(e.row, e.col)) tile_robots[board.tile_of(e.row, e.col)].push_back(static_cast<int>(i));
+    }
+}
+
+// Cells a ray or flame covers, as sorted board indices. The line runs from
+// the shooter through the aimed cell, one cell per step along the longer
+// axis with the other rounded to the nearest cell, for range steps or to
+// the board edge. A flame adds the cells either side across the line.
+std::vector<int> Arena::shot_path(ShotShape shape, int range, int fromRow, int fromCol, int shotRow, int shotCol) const {
+    std::vector<int> out;
+    long long dr = shotRow - fromRow, dc = shotCol - fromCol;
+    long long steps = std::max(std::abs(dr), std::abs(dc));
+    if (steps == 0) return out;
+    // k * d / steps to the nearest whole cell, halves away from zero
+    auto along = [steps](long long k, long long d) {
+        return static_cast<int>((2 * k * d + (d < 0 ? -steps : steps)) / (2 * steps));
+    };
+
+    bool widenRows = std::abs(dc) > std::abs(dr);
+    for (int k = 1; range <= 0 || k <= range; ++k) {
+        int r = fromRow + along(k, dr), c = fromCol + along(k, dc);
+        if (!board.in_bounds(r, c)) break;
+        out.push_back(board.index(r, c));
+        if (shape != ShotShape::flame) continue;
+        for (int side : {-1, 1}) {
+            int wr = widenRows ? r + side : r, wc = widenRows ? c : c + side;
+            if (board.in_bounds(wr, wc)) out.push_back(board.index(wr, wc));
         }
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
 
-        void* handle = dlopen(so.c_str(), RTLD_LAZY);
-        if (!handle) { std::cerr << "dlopen failed: " << so << " : " << dlerror() << "\n"; continue; }
-        dl_handles.push_back(handle);
+// Robots in the tiles a shot can reach, in robot order so hits resolve the
+// same way a scan of the whole list would, leaving out the shooter. path is
+// shot_path() for a ray or flame and unused otherwise.
+std::vector<int> Arena::shot_candidates(int shooterIdx, ShotShape shape, int shotRow, int shotCol,
+                                        const std::vector<int>& path) const {
+    std::vector<int> out;
+    auto take = [&](int tr, int tc) {
+        const auto& list = tile_robots[static_cast<size_t>(tr) * board.tile_cols() + tc];
+        out.insert(out.end(), list.begin(), list.end());
+    };
 
-        RobotFactory create_robot = (RobotFactory)dlsym(handle, "create_robot");
-        if (!create_robot) { std::cerr << "dlsym failed: create_robot in " << so << " : " << dlerror() << "\n"; continue; }
+    int tr = shotRow >> PlayingBoard::tile_shift, tc = shotCol >> PlayingBoard::tile_shift;
+    switch (shape) {
+        case ShotShape::cross:
+            for (int c = 0; c < board.tile_cols(); ++c) take(tr, c);
+            for (int r = 0; r < board.tile_rows(); ++r) if (r != tr) take(r, tc);
+            break;
 
-        std::unique_ptr<RobotBase> rb(create_robot());
-        if (!rb) { std::cerr << "create_robot returned null for " << so << "\n"; continue; }
+        case ShotShape::area: {
+            int r0 = std::max(0, shotRow - 1) >> PlayingBoard::tile_shift;
+            int r1 = std::min(board.rows() - 1, shotRow + 1) >> PlayingBoard::tile_shift;
+            int c0 = std::max(0, shotCol - 1) >> PlayingBoard::tile_shift;
+            int c1 = std::min(board.cols() - 1, shotCol + 1) >> PlayingBoard::tile_shift;
+            for (int r = r0; r <= r1; ++r)
+                for (int c = c0; c <= c1; ++c) take(r, c);
+            break;
+        }
 
-        // Set boundaries immediately
-        rb->set_boundaries(cfg.height, cfg.width);
+        case ShotShape::ray:
+        case ShotShape::flame: {
+            std::vector<std::pair<int,int>> tiles;
+            for (int idx : path) {
+                tiles.emplace_back(board.row_of(idx) >> PlayingBoard::tile_shift, board.col_of(idx) >> PlayingBoard::tile_shift);
+            }
+            std::sort(tiles.begin(), tiles.end());
+            tiles.erase(std::unique(tiles.begin(), tiles.end()), tiles.end());
+            for (auto [r, c] : tiles) take(r, c);
+            break;
+        }
+
+        default:
+            take(tr, tc);
+            break;
+    }
+
+    out.erase(std::remove(out.begin(), out.end(), shooterIdx), out.end());
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+// Live robots a shot hits, in robot order
+std::vector<int> Arena::shot_hits(int shooterIdx, ShotShape shape, int range, int shotRow, int shotCol) const {
+#ifdef ROBOTWARZ_REFERENCE_ENGINE
+    if (cfg.referenceEngine) return reference_shot_hits(shooterIdx, shape, range, shotRow, shotCol);
+#endif
+    const RobotEntry& shooter = robots[shooterIdx];
+    std::vector<int> path;
+    if (travels(shape)) path = shot_path(shape, range, shooter.row, shooter.col, shotRow, shotCol);
+
+    std::vector<int> out;
+    for (int i : shot_candidates(shooterIdx, shape, shotRow, shotCol, path)) {
+        const RobotEntry& e = robots[i];
+        if (!e.alive || e.instance == nullptr) continue;
 
-        char g = next_glyph();
+        bool hit = false;
+        switch (shape) {
+            case ShotShape::cross:
+                // Line attack: same row or col
+                hit = (e.row == shotRow || e.col == shotCol);
+                break;
+
+            case ShotShape::area:
+                // 3x3 AoE centered on shot
+                hit = (std::abs(e.row - shotRow) <= 1 && std::abs(e.col - shotCol) <= 1);
+                break;
 
-        // Derive name from filename stem
-        std::string stem = p.path().stem().string();   // e.g. "Robot_TuNe"
-        if (stem.rfind("Robot_", 0) == 0) {
-            stem = stem.substr(6); // strip "Robot_"
+            case ShotShape::ray:
+            case ShotShape::flame:
+                hit = board.in_bounds(e.row, e.col) &&
+                      std::binary_search(path.begin(), path.end(), board.index(e.row, e.col));
+                break;
+
+            default:
+                // direct cell only
+                hit = (e.row == shotRow && e.col == shotCol);
+                break;
         }
+        if (hit) out.push_back(i);
+    }
+    return out;
+}
+
+bool Arena::is_cell_free_for_robot(int r, int c) const {
+    if (!board.in_bounds(r, c)) return false;
+    char t = board.at(r, c).type;
+    return t == '.';
+}
 
+bool Arena::load_robots_from_sources(const std::string& directory) {
+    // Compile and load Robot_*.cpp from directory into this arena's own pool
+    size_t before = libs.factories().size();
+    if (!libs.load_directory(directory)) return false;
 
-        int idx = robots.add(std::move(rb), g, stem);
-        std::cout << "Robot added at index " << idx <<  " with name " << stem << "\n";
+    std::vector<RobotFactoryEntry> added(libs.factories().begin() + before, libs.factories().end());
+    return load_robots(added);
+}
 
-        anyLoaded = true;
+bool Arena::load_robots(const std::vector<RobotFactoryEntry>& roster) {
+    bool anyLoaded = false;
+    for (const auto& entry : roster) {
+        if (!entry.factory) { std::cerr << "No factory for robot " << entry.name << "\n"; continue; }
+
+        // Robots with shared statics run from a library copy leased to this
+        // arena for its lifetime
+        RobotFactory factory = entry.factory;
+        RobotTurnV2 turn = entry.turn;
+        if (entry.pinned && !entry.library.empty()) {
+            RobotFactoryEntry own;
+            auto lease = RobotLibraryPool::shared().lease_private_copy(entry, own);
+            if (!lease) continue;
+            leases.push_back(std::move(lease));
+            factory = own.factory;
+            turn = own.turn;
+        }
+        for (int copy = 0; copy < std::max(1, cfg.robotCopies); ++copy) {
+            if (add_robot(factory, entry.name, entry.pinned, turn)) anyLoaded = true;
+        }
     }
     return anyLoaded;
 }
 
+bool Arena::add_robot(RobotFactory create_robot, const std::string& name, bool sharedStatics, RobotTurnV2 turn) {
+    auto heap = RobotHeap::make();
+    std::unique_ptr<RobotBase> rb;
+    {
+        RobotHeap::Scope scope(heap.get());
+        rb.reset(create_robot());
+    }
+    if (!rb) { std::cerr << "create_robot returned null for " << name << "\n"; return false; }
+    // the budget applies from the first turn; construction is not a call
+    // the robot can forfeit
+    heap->set_limit(static_cast<size_t>(std::max(0LL, cfg.memoryBudgetKb)) * 1024);
+
+    // Set boundaries immediately
+    rb->set_boundaries(cfg.height, cfg.width);
+
+    char g = next_glyph();
+
+    int idx = robots.add(std::move(rb), g, name, create_robot, std::move(heap));
+    robots[idx].sharedStatics = sharedStatics;
+    robots[idx].turn = turn;
+    out() << "Robot added at index " << idx <<  " with name " << name << "\n";
+    return true;
+}
+
 void Arena::place_obstacles() {
-    std::uniform_int_distribution<int> rdist(0, cfg.height - 1);
-    std::uniform_int_distribution<int> cdist(0, cfg.width - 1);
+    free_cells_listed = false;
+    if (map) {
+        board = map->board(); // shares the map's tiles until they are written
+        return;
+    }
 
     auto placeN = [&](int count, char ch) {
-        int placed = 0;
-        while (placed < count) {
-            int r = rdist(rng), c = cdist(rng);
-            if (board.at(r, c).type == '.') {
-                if (board.place_obstacle(r, c, ch)) ++placed;
+        for (int placed = 0; placed < count; ++placed) {
+            auto [r, c] = random_empty_cell();
+            if (r == -1) {
+                std::cerr << "No space to place obstacle " << ch << " (" << placed << " of " << count << ")\n";
+                return;
             }
+            board.place_obstacle(r, c, ch);
         }
     };
 
@@ -95,11 +404,27 @@ void Arena::place_obstacles() {
 }
 
 void Arena::place_robots_randomly() {
+    free_cells_listed = false;
+
+    // A map's spawn points are used first, in an order drawn from the seed
+    std::vector<std::pair<int,int>> spawns;
+    if (map) {
+        spawns = map->spawns();
+        std::shuffle(spawns.begin(), spawns.end(), rng);
+    }
+
     for (size_t i = 0; i < robots.size(); ++i) {
         auto& e = robots[i];
-        auto [r, c] = random_empty_cell();
+        int r = -1, c = -1;
+        while (r == -1 && !spawns.empty()) {
+            auto [sr, sc] = spawns.back();
+            spawns.pop_back();
+            if (board.in_bounds(sr, sc) && board.at(sr, sc).type == '.') { r = sr; c = sc; }
+        }
+        if (r == -1) std::tie(r, c) = random_empty_cell();
         if (r == -1) { std::cerr << "No space to place robot " << i << "\n"; continue; }
-        e.row = r; e.col = c; e.alive = true;
+        set_robot_position(static_cast<int>(i), r, c);
+        e.alive = true;
         board.place_robot(r, c, static_cast<int>(i), true);
         e.instance->move_to(r, c);
         e.instance->set_boundaries(cfg.height, cfg.width);
@@ -107,7 +432,7 @@ void Arena::place_robots_randomly() {
 }
 
 void Arena::print_round_header(int round) {
-    std::cout << "=========== starting round " << round << " ===========" << "\n\n";
+    out() << "=========== starting round " << round << " ===========" << "\n\n";
 }
 
 
@@ -148,36 +473,64 @@ void Arena::print_round_header(int round) {
 }*/
 
 void Arena::print_state() {
-    std::cout << board.render() << "\n";
+    if (cfg.quiet) return; // skip rendering what nobody will see
+
+    // With a viewport only the window around the followed robot is shown,
+    // together with the robots inside it
+    bool viewport = cfg.viewRows > 0 && cfg.viewCols > 0;
+    int top = 0, left = 0;
+    if (viewport) {
+        int follow = std::clamp(cfg.followRobot, 0, std::max(0, static_cast<int>(robots.size()) - 1));
+        if (follow < static_cast<int>(robots.size())) {
+            top = std::clamp(robots[follow].row - cfg.viewRows / 2, 0, std::max(0, board.rows() - cfg.viewRows));
+            left = std::clamp(robots[follow].col - cfg.viewCols / 2, 0, std::max(0, board.cols() - cfg.viewCols));
+        }
+        out() << board.render(top, left, cfg.viewRows, cfg.viewCols) << "\n";
+    } else {
+        out() << board.render() << "\n";
+    }
 
     for (size_t i = 0; i < robots.size(); ++i) {
         auto& e = robots[i];
         RobotBase* r = e.instance.get();
 
-        std::cout << "R" << e.glyph << " (" << e.row << "," << e.col << ") "
-                  << "Name: " << e.name << ' ';
+        if (viewport && (e.row < top || e.row >= top + cfg.viewRows || e.col < left || e.col >= left + cfg.viewCols)) {
+            continue;
+        }
+
+        out() << "R" << e.glyph << " (" << e.row << "," << e.col << ") "
+              << "Name: " << e.name << ' ';
 
         if (r) {
-            std::cout << "Health: " << r->get_health()
-                      << " Armor: " << r->get_armor();
+            out() << "Health: " << r->get_health()
+                  << " Armor: " << r->get_armor();
         } else {
-            std::cout << "Health: N/A Armor: N/A";
+            out() << "Health: N/A Armor: N/A";
+        }
+
+        if (cfg.memoryBudgetKb > 0 && e.heap) {
+            out() << " Heap: " << e.heap->current_bytes() / 1024 << " KB (peak " << e.heap->peak_bytes() / 1024 << ")";
+        }
+        if (e.budgetBreaches > 0 || e.memoryBreaches > 0) {
+            out() << " Budget breaches: " << e.budgetBreaches;
+            if (e.memoryBreaches > 0) out() << " + " << e.memoryBreaches << " out of memory";
+            out() << " (forfeited " << e.forfeitedTurns << " turns)";
         }
 
         if (!e.alive) {
-            std::cout << " - is out";
+            out() << " - is out";
         }
-        std::cout << "\n";
+        out() << "\n";
 
         if (e.alive && r) {
-            if (!e.lastRadarLog.empty()) std::cout << "  " << e.lastRadarLog << "\n";
-            if (!e.lastShotLog.empty())  std::cout << "  " << e.lastShotLog << "\n";
-            if (!e.lastMoveLog.empty())  std::cout << "  " << e.lastMoveLog << "\n";
-            std::cout << "\n";
+            if (!e.lastRadarLog.empty()) out() << "  " << e.lastRadarLog << "\n";
+            if (!e.lastShotLog.empty())  out() << "  " << e.lastShotLog << "\n";
+            if (!e.lastMoveLog.empty())  out() << "  " << e.lastMoveLog << "\n";
+            out() << "\n";
         }
     }
 
-    std::cout << "\n";
+    out() << "\n";
 }
 
 
@@ -187,40 +540,181 @@ bool Arena::check_winner(int& winnerIdx) {
     return winnerIdx != -1;
 }
 
+// Any hit, even one the armor absorbs, restarts the quiet period
+void Arena::note_damage() {
+    last_damage_round = current_round;
+    quiet_states.clear();
+}
+
+// splitmix64 finalizer, used to key robot state for state_hash
+static uint64_t mix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// The board hash is maintained by PlayingBoard itself; robot stats change
+// inside RobotBase, so their keys are folded in here, one per live robot
+uint64_t Arena::state_hash() const {
+    uint64_t h = board.hash();
+    for (size_t i = 0; i < robots.size(); ++i) {
+        const auto& e = robots[i];
+        if (!e.alive || !e.instance) continue;
+        uint64_t key = mix64(i);
+        key = mix64(key ^ (static_cast<uint64_t>(static_cast<uint32_t>(e.row)) << 32 | static_cast<uint32_t>(e.col)));
+        key = mix64(key ^ (static_cast<uint64_t>(static_cast<uint32_t>(e.instance->get_health())) << 32 |
+                           static_cast<uint64_t>(static_cast<uint16_t>(e.instance->get_armor())) << 16 |
+                           static_cast<uint16_t>(e.instance->get_move_speed())));
+        // shots left only count for weapons that can run out
+        const WeaponRule& rule = cfg.rules.weapon(e.instance->get_weapon());
+        if (rule.ammo > 0) key = mix64(key ^ static_cast<uint64_t>(std::max(0, rule.ammo - e.shotsFired)));
+        h ^= key;
+    }
+    return h;
+}
+
+// Flood fills the open ground from every robot that can still move. Reaching
+// a cell next to another robot, or ground already filled from another robot,
+// means two robots can still meet; robots that cannot move only count when
+// they already stand next to each other. Trapping cells (pits) can be entered but end the walk.
+bool Arena::any_robot_can_reach() const {
+    const int rows = board.rows(), cols = board.cols();
+    enum : uint8_t { unseen, robot, current, earlier };
+    std::vector<uint8_t> mark(static_cast<size_t>(rows) * cols, unseen);
+
+    std::vector<int> live;
+    for (size_t i = 0; i < robots.size(); ++i) {
+        const auto& e = robots[i];
+        if (!e.alive || !e.instance || !board.in_bounds(e.row, e.col)) continue;
+        live.push_back(static_cast<int>(i));
+        mark[board.index(e.row, e.col)] = robot;
+    }
+
+    auto next_to_robot = [&](int r, int c, int self) {
+        for (int d = 1; d <= 8; ++d) {
+            int nr = r + directions[d].first, nc = c + directions[d].second;
+            if (board.in_bounds(nr, nc) && mark[board.index(nr, nc)] == robot && board.index(nr, nc) != self) return true;
+        }
+        return false;
+    };
+
+    std::vector<int> queue;
+    for (int i : live) {
+        const auto& e = robots[i];
+        int self = board.index(e.row, e.col);
+        if (next_to_robot(e.row, e.col, self)) return true;
+        if (e.instance->get_move_speed() <= 0) continue;
+
+        queue.assign(1, self);
+        for (size_t head = 0; head < queue.size(); ++head) {
+            int r = board.row_of(queue[head]), c = board.col_of(queue[head]);
+            const CellRule* here = cfg.rules.cell(board.at(r, c).type);
+            if (head > 0 && here && here->traps) continue;
+            for (int d = 1; d <= 8; ++d) {
+                int nr = r + directions[d].first, nc = c + directions[d].second;
+                if (!board.in_bounds(nr, nc)) continue;
+                int idx = board.index(nr, nc);
+                if (mark[idx] == earlier) return true; // ground another robot can reach
+                if (mark[idx] != unseen) continue;
+                char t = board.at(nr, nc).type;
+                const CellRule* cell = cfg.rules.cell(t);
+                if (t != '.' && (!cell || cell->blocks)) continue;
+                if (next_to_robot(nr, nc, self)) return true;
+                mark[idx] = current;
+                queue.push_back(idx);
+            }
+        }
+        for (size_t k = 1; k < queue.size(); ++k) mark[queue[k]] = earlier;
+    }
+    return false;
+}
+
+// Called after each round. With no damage for stalemateRounds rounds the
+// match ends once the robots have only been revisiting earlier states for
+// that long (a single repeat is common: a robot that shoots and misses), or
+// when none of them can reach another; the flood fill only runs every
+// stalemateRounds quiet rounds.
+bool Arena::check_stalemate(uint64_t stateHash) {
+    if (cfg.stalemateRounds <= 0) return false;
+
+    if (quiet_states.insert(stateHash).second) last_new_state_round = current_round;
+    int quiet = current_round - last_damage_round;
+    if (quiet < cfg.stalemateRounds) return false;
+
+    if (current_round - last_new_state_round >= cfg.stalemateRounds) {
+        end_reason = EndReason::repeated_state;
+    } else if (quiet % cfg.stalemateRounds == 0 && !any_robot_can_reach()) {
+        end_reason = EndReason::unreachable;
+    } else {
+        return false;
+    }
+    out() << "Stalemate after " << current_round << " rounds: " << end_reason_name(end_reason) << "\n";
+    return true;
+}
+
 std::vector<RadarObj> Arena::perform_radar(int robotIdx, int radarDirection) {
+#ifdef ROBOTWARZ_REFERENCE_ENGINE
+    if (cfg.referenceEngine) return reference_radar(robotIdx, radarDirection);
+#endif
+    return (this->*radar_scan)(robotIdx, radarDirection);
+}
+
+// Dispatch table: one scan_radar instance per entry of specialized_board_sizes
+Arena::RadarScan Arena::radar_for_size(int rows, int cols) {
+    static constexpr auto table = []<size_t... I>(std::index_sequence<I...>) {
+        return std::array<std::tuple<int, int, RadarScan>, sizeof...(I)>{{
+            {specialized_board_sizes[I].first, specialized_board_sizes[I].second,
+             &Arena::scan_radar<specialized_board_sizes[I].first, specialized_board_sizes[I].second>}...
+        }};
+    }(std::make_index_sequence<std::size(specialized_board_sizes)>{});
+
+    for (const auto& [r, c, scan] : table) {
+        if (r == rows && c == cols) return scan;
+    }
+    return &Arena::scan_radar<0, 0>;
+}
+
+template <int Rows, int Cols>
+std::vector<RadarObj> Arena::scan_radar(int robotIdx, int radarDirection) {
+    BoardView<Rows, Cols> view(board);
     std::vector<RadarObj> out;
-    auto& e = robots[robotIdx];
+    const auto& e = robots[robotIdx];
     int r0 = e.row, c0 = e.col;
 
     if (radarDirection == 0) {
         // 8 neighbors
+        out.reserve(8);
         for (int dr = -1; dr <= 1; ++dr) {
             for (int dc = -1; dc <= 1; ++dc) {
                 if (dr == 0 && dc == 0) continue;
                 int r = r0 + dr, c = c0 + dc;
-                if (!board.in_bounds(r, c)) continue;
-                out.emplace_back(board.at(r, c).type, r, c);
+                if (!view.in_bounds(r, c)) continue;
+                out.emplace_back(view.type_at(r, c), r, c);
             }
         }
         return out;
     }
+    if (!view.in_bounds(r0, c0)) return out;
 
     // Directions 1..8 with 3-wide ray (perpendicular offsets -1..+1)
-    auto d = directions[radarDirection];
-    int dr = d.first, dc = d.second;
+    auto [dr, dc] = directions[radarDirection];
     int pr = -dc, pc = dr; // perpendicular vector
 
-    // Walk to edge
-    int r = r0 + dr, c = c0 + dc;
-    while (board.in_bounds(r, c)) {
+    // Steps until the ray leaves the board, so the walk itself needs no
+    // bounds test; only the side cells can still fall off an edge
+    auto room = [](int p, int d, int n) { return d > 0 ? n - 1 - p : d < 0 ? p : std::numeric_limits<int>::max(); };
+    int steps = std::min(room(r0, dr, view.rows()), room(c0, dc, view.cols()));
+    out.reserve(3 * static_cast<size_t>(steps));
+
+    for (int k = 1; k <= steps; ++k) {
+        int r = r0 + k * dr, c = c0 + k * dc;
         for (int w = -1; w <= 1; ++w) {
             int rw = r + pr * w;
             int cw = c + pc * w;
-            if (!board.in_bounds(rw, cw)) continue;
-            if (rw == r0 && cw == c0) continue;
-            out.emplace_back(board.at(rw, cw).type, rw, cw);
+            if (w != 0 && (!view.in_bounds(rw, cw) || (rw == r0 && cw == c0))) continue;
+            out.emplace_back(view.type_at(rw, cw), rw, cw);
         }
-        r += dr; c += dc;
     }
     return out;
 }
@@ -237,80 +731,71 @@ void Arena::handle_shot(int shooterIdx, int shotRow, int shotCol) {
 
     // Ensure shot coordinates are in bounds before any logic that relies on them
     if (!board.in_bounds(shotRow, shotCol)) {
-        std::cout << "Robot " << shooterEntry.glyph
-                  << " attempted an out-of-bounds shot at (" << shotRow << "," << shotCol << ")\n";
+        out() << "Robot " << shooterEntry.glyph
+              << " attempted an out-of-bounds shot at (" << shotRow << "," << shotCol << ")\n";
         return;
     }
 
-    std::cout << "Robot " << shooterEntry.glyph
-              << " fired a shot at (" << shotRow << "," << shotCol << ")\n";
-
     // Weapon query (safe: shooter != nullptr above)
-    WeaponType w = shooter->get_weapon();
+    const WeaponRule& rule = cfg.rules.weapon(shooter->get_weapon());
+    bool travelling = travels(rule.shape);
+    if (!travelling && rule.range > 0 &&
+        std::max(std::abs(shotRow - shooterEntry.row), std::abs(shotCol - shooterEntry.col)) > rule.range) {
+        out() << "Robot " << shooterEntry.glyph
+              << " aimed out of range at (" << shotRow << "," << shotCol << ")\n";
+        return;
+    }
+    // a ray or flame needs a direction to travel in
+    if (travelling && shotRow == shooterEntry.row && shotCol == shooterEntry.col) {
+        out() << "Robot " << shooterEntry.glyph << " aimed at its own cell\n";
+        return;
+    }
+    if (rule.ammo > 0 && shooterEntry.shotsFired >= rule.ammo) {
+        out() << "Robot " << shooterEntry.glyph << " is out of ammo\n";
+        return;
+    }
+    ++shooterEntry.shotsFired;
 
-    for (size_t i = 0; i < robots.size(); ++i) {
+    out() << "Robot " << shooterEntry.glyph
+          << " fired a shot at (" << shotRow << "," << shotCol << ")\n";
+
+    int raw = -1; // rolled on the first hit, then the same for everyone in the blast
+    for (int i : shot_hits(shooterIdx, rule.shape, rule.range, shotRow, shotCol)) {
         RobotEntry& e = robots[i];
         RobotBase* target = e.instance.get();
 
-        // Skip dead or missing instances
-        if (!e.alive || target == nullptr) continue;
-
-        bool hit = false;
-
-        switch (w) {
-            case WeaponType::railgun:
-                // Line attack: same row or col
-                hit = (e.row == shotRow || e.col == shotCol);
-                break;
-
-            case WeaponType::hammer:
-            case WeaponType::grenade:
-            case WeaponType::flamethrower:
-                // 3x3 AoE centered on shot
-                hit = (std::abs(e.row - shotRow) <= 1 && std::abs(e.col - shotCol) <= 1);
-                break;
-
-            default:
-                // Fist or unknown: direct cell only
-                hit = (e.row == shotRow && e.col == shotCol);
-                break;
-        }
-
-        // Optional: prevent self-hit if your design requires it
-        // if (static_cast<int>(i) == shooterIdx) hit = false;
-
-        if (!hit) continue;
-
-        std::cout << "Robot " << shooterEntry.glyph
-                  << " hit Robot " << e.glyph
-                  << " at (" << e.row << "," << e.col << ")\n";
+        out() << "Robot " << shooterEntry.glyph
+              << " hit Robot " << e.glyph
+              << " at (" << e.row << "," << e.col << ")\n";
 
         // Null-safe stat reads and calculations
-        int armor = target->get_armor();           // target != nullptr ensured
-        int raw = 10;                              // placeholder damage
-        double reduction = 0.1 * static_cast<double>(armor);
-        int dealt = std::max(0, static_cast<int>(std::round(raw * (1.0 - reduction))));
+        if (raw < 0) raw = roll_damage(rule.minDamage, rule.maxDamage);
+        int dealt = armor_scaled(raw, target->get_armor()); // target != nullptr ensured
 
         // Apply damage safely
         target->take_damage(dealt);
-        target->reduce_armor(1);
+        target->reduce_armor(cfg.rules.armorLossPerHit);
+        shooterEntry.damageDealt += dealt;
+        e.damageTaken += dealt;
+        note_damage();
 
         // Recheck health via the valid pointer
         int health = target->get_health();
 
         if (health <= 0) {
             e.alive = false;
+            eliminated.push_back(i);
 
             // Only touch the board if coordinates are valid
             if (board.in_bounds(e.row, e.col)) {
                 board.set_dead(e.row, e.col);
             } else {
-                std::cout << "Warning: dead robot " << e.glyph
-                          << " has out-of-bounds coords (" << e.row << "," << e.col
-                          << "); skipping board update.\n";
+                out() << "Warning: dead robot " << e.glyph
+                      << " has out-of-bounds coords (" << e.row << "," << e.col
+                      << "); skipping board update.\n";
             }
 
-            std::cout << "Robot " << e.glyph << " has been destroyed!\n";
+            out() << "Robot " << e.glyph << " has been destroyed!\n";
 
             // Optional: do NOT reset e.instance here if you still need to print stats later.
             // e.instance.reset(); // If you choose to free immediately, ensure all later code is null-safe.
@@ -385,6 +870,9 @@ void Arena::handle_shot(int shooterIdx, int shotRow, int shotCol) {
 }*/
 
 void Arena::handle_move(int robotIdx, int moveDir, int distance) {
+#ifdef ROBOTWARZ_REFERENCE_ENGINE
+    if (cfg.referenceEngine) return reference_move(robotIdx, moveDir, distance);
+#endif
     auto& e = robots[robotIdx];
     if (!e.alive) return;
 
@@ -401,113 +889,337 @@ void Arena::handle_move(int robotIdx, int moveDir, int distance) {
         if (!board.in_bounds(nr, nc)) break;
 
         char t = board.at(nr, nc).type;
-        if (t == 'M' || t == 'R' || t == 'X') {
+        const CellRule* cell = cfg.rules.cell(t);
+        if (t == 'R' || t == 'X' || (cell && cell->blocks)) {
             // stop before obstacle/robot
             break;
-        } else if (t == 'P') {
-            // move onto pit and trap
-            board.vacate(r, c);
-            board.place_robot(nr, nc, robotIdx, true);
-            e.row = nr; e.col = nc;
-            e.instance->move_to(nr, nc);
-            e.instance->disable_movement(); // trapped
-            break;
-        } else if (t == 'F') {
-            // move through and take flamethrower damage (placeholder range 30–50)
-            board.vacate(r, c);
-            board.place_robot(nr, nc, robotIdx, true);
-            r = nr; c = nc;
-            e.row = r; e.col = c;
-            e.instance->move_to(r, c);
-            int raw = 40; // placeholder mid‑range
-            double reduction = 0.1 * e.instance->get_armor();
-            int dealt = std::max(0, (int)std::round(raw * (1.0 - reduction)));
+        }
+
+        board.vacate(r, c);
+        board.place_robot(nr, nc, robotIdx, true);
+        r = nr; c = nc;
+        set_robot_position(robotIdx, r, c);
+        e.instance->move_to(r, c);
+        if (!cell) continue;
+
+        if (cell->maxDamage > 0) {
+            // moving through hurts, e.g. a flamethrower
+            int dealt = armor_scaled(roll_damage(cell->minDamage, cell->maxDamage), e.instance->get_armor());
             e.instance->take_damage(dealt);
-            e.instance->reduce_armor(1);
+            e.instance->reduce_armor(cfg.rules.armorLossPerHit);
+            e.damageTaken += dealt;
+            note_damage();
             if (e.instance->get_health() <= 0) {
                 e.alive = false;
+                eliminated.push_back(robotIdx);
                 board.set_dead(e.row, e.col);
                 break;
             }
-        } else {
-            // empty
-            board.vacate(r, c);
-            board.place_robot(nr, nc, robotIdx, true);
-            r = nr; c = nc;
-            e.row = r; e.col = c;
-            e.instance->move_to(r, c);
+        }
+        if (cell->traps) {
+            e.instance->disable_movement(); // e.g. a pit
+            break;
         }
     }
 }
 
-void Arena::run() {
-    place_obstacles();
-    place_robots_randomly();
+// Raw damage for one shot or hazard: uniform in the rule's range, drawn from
+// the arena's generator; a fixed amount draws nothing
+int Arena::roll_damage(int minDamage, int maxDamage) {
+    if (maxDamage <= minDamage) return minDamage;
+    return std::uniform_int_distribution<int>(minDamage, maxDamage)(rng);
+}
+
+// Sense and decide: radar from the current board, then the robot's choice of
+// action. Only reads the board, so it is safe to run for many robots at once.
+void Arena::decide(int robotIdx, TurnDecision& d) {
+    auto& e = robots[robotIdx];
+    d = TurnDecision{};
+
+    // A robot that has spent its match budget is not called again
+    if (cfg.matchBudgetUs > 0 && e.cpuNs >= cfg.matchBudgetUs * 1000) {
+        d.forfeit = true;
+        return;
+    }
+
+    if (e.turn) {
+        decide_v2(robotIdx, d);
+        return;
+    }
+
+    int radarDir = 0;
+    if (!budgeted_call(e, [&] { e.instance->get_radar_direction(radarDir); })) {
+        d.forfeit = true;
+        return;
+    }
+    auto scan = perform_radar(robotIdx, radarDir);
+    bool ok = budgeted_call(e, [&] { e.instance->process_radar_results(scan); });
+    if (turn_observer) d.radar = std::move(scan);
+    if (!ok) {
+        d.forfeit = true;
+        return;
+    }
+
+    if (!budgeted_call(e, [&] { d.shoots = e.instance->get_shot_location(d.shotRow, d.shotCol); })) {
+        d.forfeit = true;
+        return;
+    }
+    if (!d.shoots) {
+        if (!budgeted_call(e, [&] { e.instance->get_move_direction(d.moveDir, d.steps); })) {
+            d.forfeit = true;
+        }
+    }
+}
+
+// v2 robots: one fused call with the scan they asked for last turn, which
+// returns the action and the direction to scan next
+void Arena::decide_v2(int robotIdx, TurnDecision& d) {
+    auto& e = robots[robotIdx];
+    auto scan = perform_radar(robotIdx, e.nextRadarDir);
+    RobotAction a{};
+    bool ok = budgeted_call(e, [&] { a = e.turn(e.instance.get(), scan.data(), scan.size()); });
+    if (turn_observer) d.radar = std::move(scan);
+    if (!ok) {
+        d.forfeit = true;
+        return;
+    }
 
+    e.nextRadarDir = a.radarDirection >= 0 && a.radarDirection <= 8 ? a.radarDirection : 0;
+    if (a.kind == robot_action_shoot) {
+        d.shoots = true;
+        d.shotRow = a.a;
+        d.shotCol = a.b;
+    } else if (a.kind == robot_action_move && a.a >= 0 && a.a <= 8) {
+        d.moveDir = a.a;
+        d.steps = a.b;
+    }
+}
+
+void Arena::act(int robotIdx, const TurnDecision& d) {
+    if (d.forfeit) {
+        ++robots[robotIdx].forfeitedTurns;
+    } else if (d.shoots) {
+        handle_shot(robotIdx, d.shotRow, d.shotCol);
+    } else if (d.moveDir != 0 && d.steps > 0) {
+        handle_move(robotIdx, d.moveDir, d.steps);
+    }
+    if (turn_observer) turn_observer(robotIdx, d);
+}
+
+void Arena::take_turn(int robotIdx) {
+    TurnDecision d;
+    decide(robotIdx, d);
+    act(robotIdx, d);
+}
+
+// Simultaneous rules: every robot decides against the start-of-round board,
+// concurrently, then shots resolve before moves, each in robot order. A robot
+// destroyed by an earlier shot this round loses its action.
+void Arena::simultaneous_round() {
+    std::vector<int> active, parallel, serial;
+    for (size_t i = 0; i < robots.size(); ++i) {
+        const auto& e = robots[i];
+        if (!e.alive || e.instance == nullptr) continue;
+        active.push_back(static_cast<int>(i));
+        // copies of a robot with writable statics share them, so never run two at once
+        (e.sharedStatics ? serial : parallel).push_back(static_cast<int>(i));
+    }
+
+    std::vector<TurnDecision> decisions(robots.size());
+    if (!decision_pool) decision_pool = std::make_unique<ThreadPool>(cfg.decisionThreads);
+    decision_pool->run(parallel.size(), [&](size_t k) { decide(parallel[k], decisions[parallel[k]]); });
+    for (int i : serial) decide(i, decisions[i]);
+
+    for (int i : active) {
+        if (decisions[i].shoots) act(i, decisions[i]);
+    }
+    for (int i : active) {
+        if (!decisions[i].shoots) act(i, decisions[i]);
+    }
+
+    if (cfg.liveView) {
+        print_state();
+        std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    }
+}
+
+int Arena::play(int lastRound) {
     int winner = -1;
-    for (int round = 1; round <= cfg.maxRounds; ++round) {
-        print_round_header(round);
+    for (; current_round <= lastRound; ++current_round) {
+        print_round_header(current_round);
         print_state();
 
         if (check_winner(winner)) {
-            std::cout << "Winner: R" << robots[winner].glyph
-                      << " at (" << robots[winner].row << "," << robots[winner].col << ")"
-                      << " Name: " << robots[winner].name << "\n";
+            out() << "Winner: R" << robots[winner].glyph
+                  << " at (" << robots[winner].row << "," << robots[winner].col << ")"
+                  << " Name: " << robots[winner].name << "\n";
+            end_reason = EndReason::winner;
             break;
         }
 
-        for (size_t i = 0; i < robots.size(); ++i) {
-            auto& e = robots[i];
-            if (!e.alive || e.instance == nullptr) continue;
+        if (cfg.simultaneousTurns) {
+            simultaneous_round();
+        } else {
+            for (size_t i = 0; i < robots.size(); ++i) {
+                auto& e = robots[i];
+                if (!e.alive || e.instance == nullptr) continue;
 
-            int radarDir = 0;
-            e.instance->get_radar_direction(radarDir);
-            auto scan = perform_radar(static_cast<int>(i), radarDir);
-            e.instance->process_radar_results(scan);
+                take_turn(static_cast<int>(i));
 
-            int shotRow = 0, shotCol = 0;
-            if (e.instance->get_shot_location(shotRow, shotCol)) {
-                handle_shot(static_cast<int>(i), shotRow, shotCol);
-            } else {
-                int moveDir = 0, steps = 0;
-                e.instance->get_move_direction(moveDir, steps);
-                if (moveDir != 0 && steps > 0) {
-                    handle_move(static_cast<int>(i), moveDir, steps);
+                if (cfg.liveView) {
+                    print_state();
+                    std::this_thread::sleep_for(std::chrono::milliseconds(600));
                 }
             }
+        }
 
-            if (cfg.liveView) {
-                print_state();
-                std::this_thread::sleep_for(std::chrono::milliseconds(600));
-            }
+        uint64_t h = state_hash();
+        round_hashes.push_back(h);
+        if (check_stalemate(h)) {
+            ++current_round;
+            break;
         }
     }
+    if (end_reason == EndReason::none && current_round > cfg.maxRounds) end_reason = EndReason::max_rounds;
+    return winner;
+}
+
+MatchResult Arena::run() {
+    place_obstacles();
+    place_robots_randomly();
+
+    current_round = 1;
+    play(cfg.maxRounds);
+    MatchResult res = result();
 
     // If no winner after all rounds → draw
-    if (winner == -1) {
-        std::cout << "The battle ended in a draw after "
-                  << cfg.maxRounds << " rounds.\n";
-        std::cout << "Robots still standing:\n";
+    if (res.winner == -1) {
+        out() << "The battle ended in a draw after "
+              << res.rounds << " rounds (" << end_reason_name(res.endReason) << ").\n";
+        out() << "Robots still standing:\n";
         for (size_t i = 0; i < robots.size(); ++i) {
             const auto& e = robots[i];
             if (e.alive && e.instance != nullptr) {
-                std::cout << "  R" << e.glyph
-                          << " (" << e.row << "," << e.col << ") "
-                          << "Name: " << e.name
-                          << " Health: " << e.instance->get_health()
-                          << " Armor: " << e.instance->get_armor()
-                          << "\n";
+                out() << "  R" << e.glyph
+                      << " (" << e.row << "," << e.col << ") "
+                      << "Name: " << e.name
+                      << " Health: " << e.instance->get_health()
+                      << " Armor: " << e.instance->get_armor()
+                      << "\n";
             }
         }
     }
+    return res;
+}
 
-    // Cleanup loaded shared libs
+MatchResult Arena::result() const {
+    MatchResult res;
+    res.winner = robots.find_last_alive();
+    res.rounds = current_round - 1;
+    res.eliminated = eliminated;
+    res.seed = cfg.rngSeed;
+    res.configHash = config_hash(cfg);
+    res.endReason = end_reason;
+    res.stateHash = state_hash();
     for (size_t i = 0; i < robots.size(); ++i) {
-        robots[i].instance.reset();
+        const auto& e = robots[i];
+        res.robots.push_back(e.name);
+        if (e.alive) res.survivors.push_back(static_cast<int>(i));
+        res.damageDealt.push_back(e.damageDealt);
+        res.damageTaken.push_back(e.damageTaken);
+        res.cpuNs.push_back(e.cpuNs);
+        res.heapPeakBytes.push_back(e.heap ? e.heap->peak_bytes() : 0);
     }
-    for (void* h : dl_handles) {
-        if (h) dlclose(h);
+    return res;
+}
+
+ArenaSnapshot Arena::snapshot() const {
+    ArenaSnapshot s{board, {}, rng, current_round, eliminated, last_damage_round, last_new_state_round, quiet_states, round_hashes};
+    s.robots.reserve(robots.size());
+    for (size_t i = 0; i < robots.size(); ++i) {
+        const auto& e = robots[i];
+        RobotSnapshot rs;
+        rs.row = e.row;
+        rs.col = e.col;
+        rs.alive = e.alive;
+        if (e.instance) {
+            rs.health = e.instance->get_health();
+            rs.armor = e.instance->get_armor();
+            rs.move = e.instance->get_move_speed();
+            rs.grenades = e.instance->get_grenades();
+        }
+        rs.damageDealt = e.damageDealt;
+        rs.damageTaken = e.damageTaken;
+        rs.shotsFired = e.shotsFired;
+        s.robots.push_back(rs);
+    }
+    return s;
+}
+
+bool Arena::restore(const ArenaSnapshot& s) {
+    if (s.robots.size() != robots.size()) {
+        std::cerr << "Snapshot has " << s.robots.size() << " robots, arena has " << robots.size() << "\n";
+        return false;
+    }
+
+    for (size_t i = 0; i < robots.size(); ++i) {
+        auto& e = robots[i];
+        const auto& rs = s.robots[i];
+        if (!e.factory) {
+            std::cerr << "Cannot restore robot " << e.name << ": no factory recorded\n";
+            return false;
+        }
+
+        // Fresh instance from the library; RobotBase stats only ever decrease,
+        // so the snapshot values are reached through the public final methods.
+        // The old instance goes first so its heap can be recycled in bulk;
+        // if it left something behind, the new one carries on in that heap.
+        e.instance.reset();
+        if (e.heap) e.heap->release();
+        else e.heap = RobotHeap::make();
+
+        std::unique_ptr<RobotBase> rb;
+        {
+            RobotHeap::Scope scope(e.heap.get());
+            e.heap->set_limit(0);
+            rb.reset(e.factory());
+        }
+        e.heap->set_limit(static_cast<size_t>(std::max(0LL, cfg.memoryBudgetKb)) * 1024);
+        if (!rb) {
+            std::cerr << "create_robot returned null while restoring " << e.name << "\n";
+            return false;
+        }
+        rb->set_boundaries(cfg.height, cfg.width);
+        rb->move_to(rs.row, rs.col);
+        rb->take_damage(rb->get_health() - rs.health);
+        rb->reduce_armor(rb->get_armor() - rs.armor);
+        if (rs.move == 0) rb->disable_movement();
+        while (rb->get_grenades() > rs.grenades) rb->decrement_grenades();
+
+        e.instance = std::move(rb);
+        e.row = rs.row;
+        e.col = rs.col;
+        e.alive = rs.alive;
+        e.damageDealt = rs.damageDealt;
+        e.damageTaken = rs.damageTaken;
+        e.shotsFired = rs.shotsFired;
+        e.nextRadarDir = 0;
+        e.lastRadarLog.clear();
+        e.lastShotLog.clear();
+        e.lastMoveLog.clear();
     }
+
+    board = s.board;
+    rng = s.rng;
+    current_round = s.round;
+    eliminated = s.eliminated;
+    last_damage_round = s.lastDamageRound;
+    last_new_state_round = s.lastNewStateRound;
+    quiet_states = s.quietStates;
+    round_hashes = s.hashTrace;
+    end_reason = EndReason::none;
+    rebuild_robot_index();
+    return true;
 }
 
 /*void Arena::run() {
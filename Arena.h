@@ -3,13 +3,22 @@
 #include <vector>
 #include <random>
 #include <filesystem>
-#include <dlfcn.h>
 #include <unordered_set>
+#include <memory>
+#include <cstdint>
+#include <ostream>
+#include <functional>
 
 #include "PlayingBoard.h"
+#include "GameMap.h"
 #include "RobotList.h"
 #include "RadarObj.h"
 #include "RobotBase.h"
+#include "RobotRegistry.h"
+#include "RobotLibraryPool.h"
+#include "ThreadPool.h"
+#include "ThreadCpuClock.h"
+#include "Rules.h"
 
 struct GameConfig {
     int width = 20;
@@ -20,39 +29,243 @@ struct GameConfig {
     int maxRounds = 100;
     bool liveView = true;
     unsigned rngSeed = 42;
+    int robotCopies = 1;   // instances created per loaded robot
+    int viewRows = 0;      // viewport size for the board display; 0 shows the whole board
+    int viewCols = 0;
+    int followRobot = 0;   // robot index the viewport is centred on
+    bool simultaneousTurns = false; // all robots decide on the same board, then actions resolve
+    unsigned decisionThreads = 0;   // threads for simultaneous decisions; 0 = one per core
+    long long callBudgetUs = 0;     // CPU time one robot call may use; 0 = no limit
+    long long matchBudgetUs = 0;    // CPU time a robot may use over the whole match; 0 = no limit
+                                    // Both are checked once the call returns and forfeit its
+                                    // turn; robot code cannot be stopped safely in-process, so a
+                                    // call that never returns hangs the match. Only a fork-mode
+                                    // tournament bounds that, by killing the worker at its
+                                    // batch deadline (TournamentConfig::matchSeconds).
+    long long memoryBudgetKb = 0;   // heap a robot may hold at once; a call that needs more
+                                    // gets std::bad_alloc and forfeits the turn; 0 = no limit
+    bool quiet = false;             // no board or action printout, e.g. tournament matches
+    bool timeRobots = false;        // track per-robot CPU time even without budgets
+    int stalemateRounds = 0;        // rounds without damage before a stalemate may end the match; 0 = never
+    std::string mapPath;            // fixed layout from a .rwm map instead of random obstacles;
+                                    // the map's size replaces width and height
+    bool referenceEngine = false;   // plain reference paths instead of the optimized ones;
+                                    // only in builds with ROBOTWARZ_REFERENCE_ENGINE
+    Rules rules = spec_rules;       // weapon and obstacle numbers (Rules.h)
+};
+
+// Board sizes (rows, cols) with radar specialized for them at compile time;
+// matches on any other size use the runtime-sized version
+inline constexpr std::pair<int,int> specialized_board_sizes[] = {{20, 20}, {64, 64}, {256, 256}};
+
+// Identifies a rule set in stored results: same hash, comparable matches
+uint64_t config_hash(const GameConfig& cfg);
+
+// Why a match stopped
+enum class EndReason {
+    none,           // still running, or stopped by play() before maxRounds
+    winner,         // at most one robot left
+    max_rounds,
+    repeated_state, // no damage and no state unseen since the last damage for stalemateRounds
+    unreachable,    // no damage for stalemateRounds and no robot can get to another
+};
+const char* end_reason_name(EndReason reason);
+
+// How a match went, in arena robot indices
+struct MatchResult {
+    std::vector<std::string> robots; // names, by index
+    int winner = -1;                 // -1 when the match ended without one
+    int rounds = 0;                  // rounds fully played
+    std::vector<int> survivors;      // still alive at the end
+    std::vector<int> eliminated;     // in the order they were destroyed
+    unsigned seed = 0;
+    uint64_t configHash = 0;
+    std::vector<int> damageDealt;    // per robot, by index
+    std::vector<int> damageTaken;
+    std::vector<long long> cpuNs;    // CPU time in robot calls; 0 unless timed or budgeted
+    std::vector<size_t> heapPeakBytes; // most heap each robot held at once
+    EndReason endReason = EndReason::none;
+    uint64_t stateHash = 0;          // Arena::state_hash() when the result was taken
+
+    // Finishing place per robot, lower is better: survivors share 0, then
+    // robots in reverse order of elimination
+    std::vector<int> places() const {
+        std::vector<int> place(robots.size(), 0);
+        int next = static_cast<int>(eliminated.size());
+        for (int idx : eliminated) {
+            if (idx >= 0 && idx < static_cast<int>(place.size())) place[idx] = next--;
+        }
+        return place;
+    }
+};
+
+// What a robot chose to do this turn
+struct TurnDecision {
+    bool shoots = false;
+    int shotRow = 0;
+    int shotCol = 0;
+    int moveDir = 0;
+    int steps = 0;
+    bool forfeit = false; // a call went over budget: the action is thrown away
+    std::vector<RadarObj> radar; // the scan the robot got; only kept for a turn observer
+};
+
+// Per-robot state a snapshot can rebuild: arena-side position plus the
+// RobotBase stats reachable through its getters.
+struct RobotSnapshot {
+    int row = -1;
+    int col = -1;
+    bool alive = false;
+    int health = 0;
+    int armor = 0;
+    int move = 0;
+    int grenades = 0;
+    int damageDealt = 0;
+    int damageTaken = 0;
+    int shotsFired = 0;
+};
+
+// Full match state at the start of a round. The robots' own decision state is
+// not part of it: restored robots are fresh instances from create_robot.
+struct ArenaSnapshot {
+    PlayingBoard board;
+    std::vector<RobotSnapshot> robots;
+    std::mt19937 rng;
+    int round;
+    std::vector<int> eliminated;
+    int lastDamageRound;
+    int lastNewStateRound;
+    std::unordered_set<uint64_t> quietStates;
+    std::vector<uint64_t> hashTrace;
 };
 
 class Arena {
 public:
     Arena(const GameConfig& cfg);
 
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
     bool load_robots_from_sources(const std::string& directory);
+    // Instantiate robots from factories that are already loaded or linked in,
+    // e.g. RobotLibraryPool::shared().factories(); the pool must outlive the arena
+    bool load_robots(const std::vector<RobotFactoryEntry>& roster);
     void place_obstacles();
     void place_robots_randomly();
 
-    void run();
+    MatchResult run();
+    // Outcome so far: winner if one robot is left, survivors and elimination order
+    MatchResult result() const;
+
+    // Plays rounds from the current round through lastRound; returns the winner index or -1.
+    int play(int lastRound);
+    int round() const { return current_round; }
+
+    // Fingerprint of the game state: the board's Zobrist hash combined with
+    // each live robot's position, health, armor, move and, for weapons with
+    // limited ammo, shots left. hash_trace()[i] is the fingerprint at the end
+    // of round i + 1.
+    uint64_t state_hash() const;
+    const std::vector<uint64_t>& hash_trace() const { return round_hashes; }
+
+    // Called after every robot's action with its decision and radar scan;
+    // engine_fuzz uses it to compare two engines turn by turn
+    using TurnObserver = std::function<void(int robotIdx, const TurnDecision& decision)>;
+    void set_turn_observer(TurnObserver fn) { turn_observer = std::move(fn); }
+
+    // Fork support: capture the match between rounds and rewind to it later
+    ArenaSnapshot snapshot() const;
+    bool restore(const ArenaSnapshot& s);
 
 private:
     GameConfig cfg;
     PlayingBoard board;
+    std::shared_ptr<const GameMap> map; // set when cfg.mapPath loaded
+    // declared before robots so instances are destroyed before their libraries close
+    RobotLibraryPool libs;
+    std::vector<RobotLibraryPool::Lease> leases; // private copies for pinned robots
     RobotList robots;
 
     std::mt19937 rng;
-    std::vector<void*> dl_handles;
+    int current_round = 1;
+    size_t glyph_counter = 0;
+
+    // flat indices of empty cells, listed by random_empty_cell once a board is
+    // too crowded for random draws and consumed as cells are handed out
+    std::vector<int> free_cells;
+    bool free_cells_listed = false;
+
+    // live robot indices per board tile, so shots only look at nearby robots
+    std::vector<std::vector<int>> tile_robots;
+
+    // decision threads for simultaneous turns, started on first use
+    std::unique_ptr<ThreadPool> decision_pool;
+
+    // robots in the order they were destroyed
+    std::vector<int> eliminated;
+
+    // stalemate detection: the last round anyone took damage, the state
+    // hashes seen since and the last round that produced an unseen one
+    int last_damage_round = 0;
+    int last_new_state_round = 0;
+    std::unordered_set<uint64_t> quiet_states;
+    EndReason end_reason = EndReason::none;
+    std::vector<uint64_t> round_hashes;
+    TurnObserver turn_observer;
+    // out() for a quiet arena: it has no buffer, so every << fails its
+    // sentry check and returns without formatting anything
+    std::ostream discard{nullptr};
 
     // helpers
+    std::ostream& out();
+    bool add_robot(RobotFactory create_robot, const std::string& name, bool sharedStatics = false,
+                   RobotTurnV2 turn = nullptr);
+    void collect_free_cells();
     std::pair<int,int> random_empty_cell();
+    void set_robot_position(int robotIdx, int r, int c);
+    void rebuild_robot_index();
+    std::vector<int> shot_path(ShotShape shape, int range, int fromRow, int fromCol, int shotRow, int shotCol) const;
+    std::vector<int> shot_candidates(int shooterIdx, ShotShape shape, int shotRow, int shotCol,
+                                     const std::vector<int>& path) const;
+    std::vector<int> shot_hits(int shooterIdx, ShotShape shape, int range, int shotRow, int shotCol) const;
+    int roll_damage(int minDamage, int maxDamage);
     char next_glyph();
 
     void print_round_header(int round);
     void print_state();
     bool check_winner(int& winnerIdx);
+    void note_damage();
+    bool any_robot_can_reach() const;
+    bool check_stalemate(uint64_t stateHash);
 
     // action orchestration stubs (to be expanded with full rules)
     std::vector<RadarObj> perform_radar(int robotIdx, int radarDirection);
+    // perform_radar for a board of Rows x Cols, or any size for <0, 0>;
+    // radar_scan is the instance for this arena's board, picked once
+    template <int Rows, int Cols>
+    std::vector<RadarObj> scan_radar(int robotIdx, int radarDirection);
+    using RadarScan = std::vector<RadarObj> (Arena::*)(int robotIdx, int radarDirection);
+    RadarScan radar_scan = nullptr;
+    static RadarScan radar_for_size(int rows, int cols);
     void handle_shot(int shooterIdx, int shotRow, int shotCol);
     void handle_move(int robotIdx, int moveDir, int distance);
+    template <typename Fn>
+    bool budgeted_call(RobotEntry& e, Fn&& fn);
+    void decide(int robotIdx, TurnDecision& d);
+    void decide_v2(int robotIdx, TurnDecision& d);
+    void act(int robotIdx, const TurnDecision& d);
+    void take_turn(int robotIdx);
+    void simultaneous_round();
 
     // placement safety
     bool is_cell_free_for_robot(int r, int c) const;
+
+#ifdef ROBOTWARZ_REFERENCE_ENGINE
+    // ArenaReference.cpp: plain versions of the optimized paths
+    std::pair<int,int> reference_empty_cell();
+    std::vector<int> reference_shot_hits(int shooterIdx, ShotShape shape, int range, int shotRow, int shotCol) const;
+    std::vector<RadarObj> reference_radar(int robotIdx, int radarDirection);
+    void reference_move(int robotIdx, int moveDir, int distance);
+    bool reference_hazard(int robotIdx, const CellRule& cell);
+#endif
 };
@@ -0,0 +1,182 @@
+#include "Arena.h"
+#include <algorithm>
+#include <cmath>
+
+// Reference engine: the plain versions of the arena paths that have (or will
+// get) optimized replacements - placement, shot targeting, radar and moves.
+// They are only built with -DROBOTWARZ_REFERENCE_ENGINE and used when
+// GameConfig::referenceEngine is set, so engine_fuzz can run both engines
+// side by side and flag any optimization that changes a game. Keep them
+// simple and change them only when the rules change.
+#ifdef ROBOTWARZ_REFERENCE_ENGINE
+
+// Rejection sampling over the whole board
+std::pair<int,int> Arena::reference_empty_cell() {
+    std::uniform_int_distribution<int> rdist(0, board.rows() - 1);
+    std::uniform_int_distribution<int> cdist(0, board.cols() - 1);
+    for (int tries = 0; tries < 10000; ++tries) {
+        int r = rdist(rng), c = cdist(rng);
+        if (board.at(r, c).type == '.') return {r, c};
+    }
+    return {-1, -1};
+}
+
+// Lists every cell the shot covers, then checks each robot against the list.
+// A ray or flame is walked in floating point: step k lands on shooter +
+// k * (aim - shooter) / steps, rounded to the nearest cell with halves away
+// from zero, steps being the longer axis of the aim.
+std::vector<int> Arena::reference_shot_hits(int shooterIdx, ShotShape shape, int range, int shotRow, int shotCol) const {
+    const auto& shooter = robots[shooterIdx];
+    std::vector<std::pair<int,int>> cells;
+    switch (shape) {
+        case ShotShape::cell:
+            cells.emplace_back(shotRow, shotCol);
+            break;
+        case ShotShape::area:
+            for (int r = shotRow - 1; r <= shotRow + 1; ++r)
+                for (int c = shotCol - 1; c <= shotCol + 1; ++c) cells.emplace_back(r, c);
+            break;
+        case ShotShape::cross:
+            for (int r = 0; r < board.rows(); ++r) cells.emplace_back(r, shotCol);
+            for (int c = 0; c < board.cols(); ++c) cells.emplace_back(shotRow, c);
+            break;
+        case ShotShape::ray:
+        case ShotShape::flame: {
+            double dr = shotRow - shooter.row, dc = shotCol - shooter.col;
+            double steps = std::max(std::abs(dr), std::abs(dc));
+            if (steps == 0) break;
+            for (int k = 1; range <= 0 || k <= range; ++k) {
+                int r = shooter.row + static_cast<int>(std::round(k * dr / steps));
+                int c = shooter.col + static_cast<int>(std::round(k * dc / steps));
+                if (!board.in_bounds(r, c)) break;
+                cells.emplace_back(r, c);
+                if (shape != ShotShape::flame) continue;
+                // 3 wide: the cells either side across the direction of travel
+                if (std::abs(dc) > std::abs(dr)) {
+                    cells.emplace_back(r - 1, c);
+                    cells.emplace_back(r + 1, c);
+                } else {
+                    cells.emplace_back(r, c - 1);
+                    cells.emplace_back(r, c + 1);
+                }
+            }
+            break;
+        }
+    }
+
+    std::vector<int> out;
+    for (size_t i = 0; i < robots.size(); ++i) {
+        const auto& e = robots[i];
+        if (static_cast<int>(i) == shooterIdx || !e.alive || e.instance == nullptr) continue;
+        if (std::find(cells.begin(), cells.end(), std::make_pair(e.row, e.col)) != cells.end()) {
+            out.push_back(static_cast<int>(i));
+        }
+    }
+    return out;
+}
+
+std::vector<RadarObj> Arena::reference_radar(int robotIdx, int radarDirection) {
+    std::vector<RadarObj> out;
+    auto& e = robots[robotIdx];
+    int r0 = e.row, c0 = e.col;
+
+    if (radarDirection == 0) {
+        // 8 neighbors
+        for (int dr = -1; dr <= 1; ++dr) {
+            for (int dc = -1; dc <= 1; ++dc) {
+                if (dr == 0 && dc == 0) continue;
+                int r = r0 + dr, c = c0 + dc;
+                if (!board.in_bounds(r, c)) continue;
+                out.emplace_back(board.at(r, c).type, r, c);
+            }
+        }
+        return out;
+    }
+
+    // Directions 1..8 with 3-wide ray (perpendicular offsets -1..+1)
+    auto d = directions[radarDirection];
+    int dr = d.first, dc = d.second;
+    int pr = -dc, pc = dr; // perpendicular vector
+
+    // Walk to edge
+    int r = r0 + dr, c = c0 + dc;
+    while (board.in_bounds(r, c)) {
+        for (int w = -1; w <= 1; ++w) {
+            int rw = r + pr * w;
+            int cw = c + pc * w;
+            if (!board.in_bounds(rw, cw)) continue;
+            if (rw == r0 && cw == c0) continue;
+            out.emplace_back(board.at(rw, cw).type, rw, cw);
+        }
+        r += dr; c += dc;
+    }
+    return out;
+}
+
+void Arena::reference_move(int robotIdx, int moveDir, int distance) {
+    auto& e = robots[robotIdx];
+    if (!e.alive) return;
+
+    // Cap by robot max move
+    int maxMove = e.instance->get_move_speed();
+    if (distance > maxMove) distance = maxMove;
+
+    auto d = directions[moveDir];
+    int dr = d.first, dc = d.second;
+
+    int r = e.row, c = e.col;
+    for (int step = 0; step < distance; ++step) {
+        int nr = r + dr, nc = c + dc;
+        if (!board.in_bounds(nr, nc)) break;
+
+        char t = board.at(nr, nc).type;
+        const CellRule* cell = cfg.rules.cell(t);
+        if (t == 'R' || t == 'X' || (cell && cell->blocks)) {
+            // stop before obstacle/robot
+            break;
+        } else if (cell && cell->traps) {
+            // move onto it and trap, after any damage it does
+            board.vacate(r, c);
+            board.place_robot(nr, nc, robotIdx, true);
+            set_robot_position(robotIdx, nr, nc);
+            e.instance->move_to(nr, nc);
+            if (cell->maxDamage > 0 && reference_hazard(robotIdx, *cell)) break;
+            e.instance->disable_movement(); // trapped
+            break;
+        } else if (cell) {
+            // move through and take damage
+            board.vacate(r, c);
+            board.place_robot(nr, nc, robotIdx, true);
+            r = nr; c = nc;
+            set_robot_position(robotIdx, r, c);
+            e.instance->move_to(r, c);
+            if (cell->maxDamage > 0 && reference_hazard(robotIdx, *cell)) break;
+        } else {
+            // empty
+            board.vacate(r, c);
+            board.place_robot(nr, nc, robotIdx, true);
+            r = nr; c = nc;
+            set_robot_position(robotIdx, r, c);
+            e.instance->move_to(r, c);
+        }
+    }
+}
+
+// Damage from the cell a robot just entered; true if it destroyed the robot
+bool Arena::reference_hazard(int robotIdx, const CellRule& cell) {
+    auto& e = robots[robotIdx];
+    int raw = cell.minDamage;
+    if (cell.maxDamage > cell.minDamage) raw = std::uniform_int_distribution<int>(cell.minDamage, cell.maxDamage)(rng);
+    int dealt = armor_scaled(raw, e.instance->get_armor());
+    e.instance->take_damage(dealt);
+    e.instance->reduce_armor(cfg.rules.armorLossPerHit);
+    e.damageTaken += dealt;
+    note_damage();
+    if (e.instance->get_health() > 0) return false;
+    e.alive = false;
+    eliminated.push_back(robotIdx);
+    board.set_dead(e.row, e.col);
+    return true;
+}
+
+#endif // ROBOTWARZ_REFERENCE_ENGINE
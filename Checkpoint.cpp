@@ -0,0 +1,223 @@
+#include "Checkpoint.h"
+#include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace {
+
+uint32_t fnv32(const unsigned char* p, size_t n) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; ++i) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+template <typename T>
+void put(std::vector<unsigned char>& buf, T v) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(&v);
+    buf.insert(buf.end(), p, p + sizeof(T));
+}
+
+template <typename T>
+void put_list(std::vector<unsigned char>& buf, const std::vector<T>& v) {
+    put<uint32_t>(buf, static_cast<uint32_t>(v.size()));
+    for (const T& x : v) put<T>(buf, x);
+}
+
+// Reads values back out of a payload; any read past the end fails the whole record
+struct Cursor {
+    const unsigned char* p;
+    const unsigned char* end;
+    bool ok = true;
+
+    template <typename T>
+    T get() {
+        T v{};
+        if (static_cast<size_t>(end - p) < sizeof(T)) { ok = false; return v; }
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return v;
+    }
+
+    template <typename T>
+    void get_list(std::vector<T>& v) {
+        uint32_t n = get<uint32_t>();
+        if (!ok || n > static_cast<size_t>(end - p) / sizeof(T)) { ok = false; return; }
+        v.resize(n);
+        for (auto& x : v) x = get<T>();
+    }
+
+    std::string get_string() {
+        uint32_t n = get<uint32_t>();
+        if (!ok || n > static_cast<size_t>(end - p)) { ok = false; return {}; }
+        std::string s(reinterpret_cast<const char*>(p), n);
+        p += n;
+        return s;
+    }
+};
+
+void put_match(std::vector<unsigned char>& buf, int matchNo, const MatchResult& r) {
+    put<int32_t>(buf, matchNo);
+    put<uint32_t>(buf, static_cast<uint32_t>(r.robots.size()));
+    for (const auto& name : r.robots) {
+        put<uint32_t>(buf, static_cast<uint32_t>(name.size()));
+        buf.insert(buf.end(), name.begin(), name.end());
+    }
+    put<int32_t>(buf, r.winner);
+    put<int32_t>(buf, r.rounds);
+    put_list<int>(buf, r.survivors);
+    put_list<int>(buf, r.eliminated);
+    put<uint32_t>(buf, r.seed);
+    put<uint64_t>(buf, r.configHash);
+    put_list<int>(buf, r.damageDealt);
+    put_list<int>(buf, r.damageTaken);
+    put_list<long long>(buf, r.cpuNs);
+    put_list<size_t>(buf, r.heapPeakBytes);
+    put<int32_t>(buf, static_cast<int32_t>(r.endReason));
+    put<uint64_t>(buf, r.stateHash);
+}
+
+bool get_match(Cursor& in, TournamentCheckpoint::Match& m) {
+    m.matchNo = in.get<int32_t>();
+    MatchResult& r = m.result;
+    uint32_t robots = in.get<uint32_t>();
+    for (uint32_t i = 0; i < robots && in.ok; ++i) r.robots.push_back(in.get_string());
+    r.winner = in.get<int32_t>();
+    r.rounds = in.get<int32_t>();
+    in.get_list(r.survivors);
+    in.get_list(r.eliminated);
+    r.seed = in.get<uint32_t>();
+    r.configHash = in.get<uint64_t>();
+    in.get_list(r.damageDealt);
+    in.get_list(r.damageTaken);
+    in.get_list(r.cpuNs);
+    in.get_list(r.heapPeakBytes);
+    r.endReason = static_cast<EndReason>(in.get<int32_t>());
+    r.stateHash = in.get<uint64_t>();
+    return in.ok && in.p == in.end;
+}
+
+} // namespace
+
+TournamentCheckpoint::~TournamentCheckpoint() {
+    if (m_fd >= 0) {
+        ::fsync(m_fd);
+        ::close(m_fd);
+    }
+}
+
+bool TournamentCheckpoint::open(const std::string& path, uint64_t fingerprint, uint64_t resultsBytes) {
+    m_path = path;
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (m_fd < 0) {
+        std::cerr << "Cannot open checkpoint " << path << "\n";
+        return false;
+    }
+
+    struct stat st{};
+    if (::fstat(m_fd, &st) != 0) {
+        std::cerr << "Cannot stat checkpoint " << path << "\n";
+        return false;
+    }
+    std::vector<unsigned char> data(static_cast<size_t>(st.st_size));
+    if (!data.empty() && ::pread(m_fd, data.data(), data.size(), 0) != static_cast<ssize_t>(data.size())) {
+        std::cerr << "Cannot read checkpoint " << path << "\n";
+        return false;
+    }
+
+    // Walk the records; the first one that does not check out ends the log
+    size_t at = 0;
+    bool begun = false;
+    while (data.size() - at >= sizeof(RecordHeader)) {
+        RecordHeader h;
+        std::memcpy(&h, data.data() + at, sizeof(h));
+        const unsigned char* payload = data.data() + at + sizeof(h);
+        if (h.magic != record_magic || h.bytes > data.size() - at - sizeof(h) || h.checksum != fnv32(payload, h.bytes)) break;
+
+        Cursor in{payload, payload + h.bytes};
+        if (!begun) {
+            if (h.kind != begin_record) break;
+            if (in.get<uint64_t>() != fingerprint) {
+                std::cerr << "Checkpoint " << path << " belongs to a different tournament "
+                          << "(other robots, settings or seed); remove it to start over\n";
+                return false;
+            }
+            m_resultsBytes = m_startResultsBytes = in.get<uint64_t>();
+            begun = true;
+        } else if (h.kind == match_record) {
+            Match m;
+            if (!get_match(in, m)) break;
+            m_completed.push_back(std::move(m));
+        } else if (h.kind == results_record) {
+            m_resultsBytes = in.get<uint64_t>();
+            m_inResults = m_completed.size();
+        } else if (h.kind == finished_record) {
+            m_finished = true;
+        } else {
+            break;
+        }
+        at += sizeof(h) + h.bytes;
+    }
+
+    if (at != data.size()) {
+        std::cerr << "Checkpoint " << path << ": dropping " << data.size() - at << " bytes of torn records\n";
+        if (::ftruncate(m_fd, static_cast<off_t>(at)) != 0) {
+            std::cerr << "Cannot truncate checkpoint " << path << "\n";
+            return false;
+        }
+    }
+    if (::lseek(m_fd, static_cast<off_t>(at), SEEK_SET) < 0) return false;
+
+    if (!begun) {
+        std::vector<unsigned char> payload;
+        put<uint64_t>(payload, fingerprint);
+        put<uint64_t>(payload, resultsBytes);
+        m_resultsBytes = m_startResultsBytes = resultsBytes;
+        if (!append(begin_record, payload) || !sync()) return false;
+    }
+    return true;
+}
+
+bool TournamentCheckpoint::append(Kind kind, const std::vector<unsigned char>& payload) {
+    if (m_fd < 0) return false;
+    RecordHeader h{record_magic, kind, static_cast<uint32_t>(payload.size()), fnv32(payload.data(), payload.size())};
+    std::vector<unsigned char> buf(sizeof(h));
+    std::memcpy(buf.data(), &h, sizeof(h));
+    buf.insert(buf.end(), payload.begin(), payload.end());
+
+    // One write per record, so a crash tears at most the last one
+    ssize_t n = ::write(m_fd, buf.data(), buf.size());
+    if (n != static_cast<ssize_t>(buf.size())) {
+        std::cerr << "Short write to checkpoint " << m_path << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool TournamentCheckpoint::append_match(int matchNo, const MatchResult& result) {
+    std::vector<unsigned char> payload;
+    put_match(payload, matchNo, result);
+    return append(match_record, payload);
+}
+
+bool TournamentCheckpoint::mark_results(uint64_t resultsBytes) {
+    std::vector<unsigned char> payload;
+    put<uint64_t>(payload, resultsBytes);
+    return append(results_record, payload);
+}
+
+bool TournamentCheckpoint::mark_finished() {
+    return append(finished_record, {}) && sync();
+}
+
+bool TournamentCheckpoint::sync() {
+    if (m_fd < 0 || ::fsync(m_fd) != 0) {
+        std::cerr << "Cannot sync checkpoint " << m_path << "\n";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "Arena.h"
+
+// Append-only log a tournament keeps so it can be resumed after a crash.
+//
+// Every record is a RecordHeader followed by its payload, written with one
+// write() as soon as it is made, so it survives the process dying (a robot
+// segfaulting in its library, say); sync() fsyncs, which makes it survive the
+// machine going down too. A torn last record fails its length or checksum and
+// is cut off when the log is reopened.
+//
+//   begin     the tournament's fingerprint and the results file size at start
+//   match     match number and its full MatchResult
+//   results   results file size after a flush and fdatasync; the matches
+//             logged before it are all in the results file
+//   finished  every match has been played
+class TournamentCheckpoint {
+public:
+    struct RecordHeader {
+        uint32_t magic;
+        uint32_t kind;
+        uint32_t bytes;    // payload
+        uint32_t checksum; // FNV-1a of the payload
+    };
+
+    enum Kind : uint32_t { begin_record = 1, match_record, results_record, finished_record };
+
+    static constexpr uint32_t record_magic = 0x4b435752; // "RWCK"
+
+    struct Match {
+        int matchNo;
+        MatchResult result;
+    };
+
+    TournamentCheckpoint() = default;
+    ~TournamentCheckpoint();
+
+    TournamentCheckpoint(const TournamentCheckpoint&) = delete;
+    TournamentCheckpoint& operator=(const TournamentCheckpoint&) = delete;
+
+    // Opens or creates the log. An existing log is read back and kept going;
+    // it must have been started with the same fingerprint. resultsBytes is
+    // the results file size now, recorded when the log is new.
+    bool open(const std::string& path, uint64_t fingerprint, uint64_t resultsBytes);
+
+    // What earlier runs logged, in the order the matches finished
+    const std::vector<Match>& completed() const { return m_completed; }
+    bool finished() const { return m_finished; }
+    // completed()[0, matches_in_results()) are in the results file, which
+    // held results_bytes() bytes at that point
+    size_t matches_in_results() const { return m_inResults; }
+    uint64_t results_bytes() const { return m_resultsBytes; }
+    // The results file size when the tournament began, before any of its matches
+    uint64_t start_results_bytes() const { return m_startResultsBytes; }
+
+    bool append_match(int matchNo, const MatchResult& result);
+    bool mark_results(uint64_t resultsBytes);
+    bool mark_finished();
+    bool sync();
+
+private:
+    std::string m_path;
+    int m_fd = -1;
+    std::vector<Match> m_completed;
+    bool m_finished = false;
+    size_t m_inResults = 0;
+    uint64_t m_resultsBytes = 0;
+    uint64_t m_startResultsBytes = 0;
+
+    bool append(Kind kind, const std::vector<unsigned char>& payload);
+};
@@ -0,0 +1,171 @@
+#include "GameMap.h"
+#include <iostream>
+#include <sstream>
+#include <cstdio>
+#include <fstream>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <mutex>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+size_t pad4(size_t n) { return (n + 3) & ~size_t{3}; }
+
+bool obstacle(char t) { return t == 'M' || t == 'F' || t == 'P'; }
+
+} // namespace
+
+std::shared_ptr<const GameMap> GameMap::load(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Cannot open map " << path << "\n";
+        return nullptr;
+    }
+    struct stat st{};
+    size_t size = fstat(fd, &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+    void* p = size >= sizeof(Header) ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        std::cerr << "Cannot map " << path << "\n";
+        return nullptr;
+    }
+    const unsigned char* data = static_cast<const unsigned char*>(p);
+
+    Header h;
+    std::memcpy(&h, data, sizeof(h));
+    size_t plane = static_cast<size_t>(h.rows) * h.cols;
+    size_t need = sizeof(h) + pad4(plane) + static_cast<size_t>(h.spawns) * 2 * sizeof(uint32_t);
+    if (h.magic != file_magic || h.version != format_version || h.rows == 0 || h.cols == 0 ||
+        h.rows > 1u << 20 || h.cols > 1u << 20 || size < need) {
+        std::cerr << path << " is not a version " << format_version << " map file\n";
+        munmap(p, size);
+        return nullptr;
+    }
+
+    PlayingBoard board(static_cast<int>(h.rows), static_cast<int>(h.cols));
+    const char* cells = reinterpret_cast<const char*>(data + sizeof(h));
+    for (size_t idx = 0; idx < plane; ++idx) {
+        if (obstacle(cells[idx])) board.place_obstacle(static_cast<int>(idx / h.cols), static_cast<int>(idx % h.cols), cells[idx]);
+    }
+
+    std::vector<std::pair<int,int>> spawns(h.spawns);
+    const unsigned char* sp = data + sizeof(h) + pad4(plane);
+    for (auto& s : spawns) {
+        uint32_t rc[2];
+        std::memcpy(rc, sp, sizeof(rc));
+        sp += sizeof(rc);
+        s = {static_cast<int>(rc[0]), static_cast<int>(rc[1])};
+    }
+    munmap(p, size);
+    return std::make_shared<const GameMap>(std::move(board), std::move(spawns));
+}
+
+std::shared_ptr<const GameMap> GameMap::shared(const std::string& path) {
+    static std::mutex mutex;
+    static std::map<std::string, std::shared_ptr<const GameMap>> loaded;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = loaded.find(path);
+    if (it != loaded.end()) return it->second;
+    auto map = load(path);
+    if (map) loaded.emplace(path, map);
+    return map;
+}
+
+std::shared_ptr<const GameMap> GameMap::parse_ascii(std::istream& in) {
+    std::vector<std::string> rows;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream ls(line);
+        std::string label, tok, cells;
+        if (!(ls >> label) || label.find_first_not_of("0123456789") != std::string::npos) continue;
+
+        bool isRow = true;
+        while (ls >> tok) {
+            if (tok.size() != 1 || std::string(".MFPRX").find(tok[0]) == std::string::npos) { isRow = false; break; }
+            cells += tok[0];
+        }
+        // the column header is all numbers, so it fails the cell check
+        if (!isRow || cells.empty()) continue;
+        // label is all digits, but may still be too long for an unsigned long
+        unsigned long row = 0;
+        try {
+            row = std::stoul(label);
+        } catch (const std::exception&) {
+            std::cerr << "Board row label " << label << " is not a row number\n";
+            return nullptr;
+        }
+        if (row != rows.size()) {
+            std::cerr << "Expected board row " << rows.size() << ", found row " << label << "\n";
+            return nullptr;
+        }
+        if (!rows.empty() && cells.size() != rows[0].size()) {
+            std::cerr << "Board row " << label << " has " << cells.size() << " cells, expected " << rows[0].size() << "\n";
+            return nullptr;
+        }
+        rows.push_back(cells);
+    }
+    if (rows.empty()) {
+        std::cerr << "No board rows found\n";
+        return nullptr;
+    }
+
+    PlayingBoard board(static_cast<int>(rows.size()), static_cast<int>(rows[0].size()));
+    std::vector<std::pair<int,int>> spawns;
+    for (int r = 0; r < board.rows(); ++r) {
+        for (int c = 0; c < board.cols(); ++c) {
+            char t = rows[r][c];
+            if (obstacle(t)) board.place_obstacle(r, c, t);
+            else if (t == 'R') spawns.emplace_back(r, c);
+        }
+    }
+    return std::make_shared<const GameMap>(std::move(board), std::move(spawns));
+}
+
+bool GameMap::save(const std::string& path) const {
+    Header h{file_magic, format_version, static_cast<uint32_t>(rows()), static_cast<uint32_t>(cols()),
+             static_cast<uint32_t>(m_spawns.size()), 0};
+    size_t plane = static_cast<size_t>(rows()) * cols();
+
+    std::vector<char> buf(sizeof(h) + pad4(plane), 0);
+    std::memcpy(buf.data(), &h, sizeof(h));
+    char* cells = buf.data() + sizeof(h);
+    for (int r = 0; r < rows(); ++r) {
+        for (int c = 0; c < cols(); ++c) {
+            char t = m_board.at(r, c).type;
+            cells[static_cast<size_t>(r) * cols() + c] = obstacle(t) ? t : '.';
+        }
+    }
+    for (const auto& [r, c] : m_spawns) {
+        uint32_t rc[2] = {static_cast<uint32_t>(r), static_cast<uint32_t>(c)};
+        buf.insert(buf.end(), reinterpret_cast<const char*>(rc), reinterpret_cast<const char*>(rc) + sizeof(rc));
+    }
+
+    // Write beside the target and rename, so a reader never sees half a map
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out.write(buf.data(), static_cast<std::streamsize>(buf.size()))) {
+            std::cerr << "Cannot write " << tmp << "\n";
+            return false;
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::cerr << "Cannot rename " << tmp << " to " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+uint64_t GameMap::hash() const {
+    uint64_t h = m_board.hash() ^ (static_cast<uint64_t>(rows()) << 32 | static_cast<uint32_t>(cols()));
+    for (const auto& [r, c] : m_spawns) {
+        h ^= PlayingBoard::cell_key(m_board.index(r, c), 'R', -1);
+    }
+    return h;
+}
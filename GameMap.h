@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <istream>
+#include <cstdint>
+
+#include "PlayingBoard.h"
+
+// A fixed arena layout: obstacles plus optional robot spawn points, stored
+// in a compact binary .rwm file
+//
+//   Header       magic, version, rows, cols, spawn count
+//   cells        rows * cols bytes, row-major: '.', 'M', 'F' or 'P';
+//                padded to 4 bytes
+//   spawns       spawn count (row, col) pairs of u32
+//
+// A map is mapped and decoded once into a prototype board. Arenas then start
+// from a copy of that board, which only shares its tiles (copy-on-write), so
+// one loaded map serves every match and thread without per-match placement.
+class GameMap {
+public:
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t rows;
+        uint32_t cols;
+        uint32_t spawns;
+        uint32_t reserved;
+    };
+
+    static constexpr uint32_t file_magic = 0x504d5752; // "RWMP"
+    static constexpr uint32_t format_version = 1;
+
+    GameMap(PlayingBoard board, std::vector<std::pair<int,int>> spawns)
+        : m_board(std::move(board)), m_spawns(std::move(spawns)) {}
+
+    // Maps and decodes a .rwm file; nullptr (with a message) if it is not one
+    static std::shared_ptr<const GameMap> load(const std::string& path);
+    // Same, but each path is only loaded once per process and then shared
+    static std::shared_ptr<const GameMap> shared(const std::string& path);
+
+    // Reads the ASCII board PlayingBoard::render() prints: lines of a row
+    // number followed by one cell character per column. 'R' cells become
+    // spawn points; 'X' (dead robot) reads as empty.
+    static std::shared_ptr<const GameMap> parse_ascii(std::istream& in);
+
+    bool save(const std::string& path) const;
+
+    int rows() const { return m_board.rows(); }
+    int cols() const { return m_board.cols(); }
+    const PlayingBoard& board() const { return m_board; }
+    const std::vector<std::pair<int,int>>& spawns() const { return m_spawns; }
+    // Identifies the layout: board hash mixed with the spawn points
+    uint64_t hash() const;
+
+private:
+    PlayingBoard m_board;
+    std::vector<std::pair<int,int>> m_spawns;
+};
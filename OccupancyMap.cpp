@@ -0,0 +1,43 @@
+#include "OccupancyMap.h"
+
+void OccupancyMap::resize(int rows, int cols) {
+    m_rows = rows > 0 ? rows : 0;
+    m_cols = cols > 0 ? cols : 0;
+    m_tileCols = (m_cols + 63) / 64;
+    size_t tiles = static_cast<size_t>((m_rows + 63) / 64) * m_tileCols;
+    for (Plane* plane : { &m_seen, &m_blocked, &m_hazard }) {
+        plane->clear();
+        plane->resize(tiles);
+    }
+    m_seenCount = 0;
+    m_changes.clear();
+    ++m_epoch;
+}
+
+// Sets or clears one bit; returns whether it changed
+bool OccupancyMap::assign(Plane& plane, int r, int c, bool on) {
+    auto& t = plane[tile(r, c)];
+    if (!t) {
+        if (!on) return false;
+        t.reset(new uint64_t[64]());
+    }
+    uint64_t mask = uint64_t{1} << (c & 63);
+    uint64_t& word = t[r & 63];
+    bool was = word & mask;
+    if (on) word |= mask;
+    else word &= ~mask;
+    return was != on;
+}
+
+void OccupancyMap::mark(int r, int c, char type) {
+    if (!in_bounds(r, c)) return;
+    if (assign(m_seen, r, c, true)) ++m_seenCount;
+
+    bool changed = assign(m_blocked, r, c, type == 'M' || type == 'X');
+    changed |= assign(m_hazard, r, c, type == 'P' || type == 'F');
+    if (changed) m_changes.push_back(r * m_cols + c);
+}
+
+void OccupancyMap::update(const std::vector<RadarObj>& results) {
+    for (const auto& obj : results) mark(obj.m_row, obj.m_col, obj.m_type);
+}
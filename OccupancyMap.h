@@ -0,0 +1,73 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+#include "RadarObj.h"
+
+// Robot-side memory of the board, built from radar results. Each cell has one
+// bit for "seen", one for "blocked" (mound or dead robot: stops movement) and
+// one for "hazard" (pit or flamethrower). Each bit plane is cut into 64x64
+// tiles, one word per tile row, allocated when a bit in them is first set, so
+// unexplored regions and the mostly empty obstacle planes cost nothing; even a
+// fully seen 1000x1000 board stays under 400 KB, and every lookup is O(1). Link OccupancyMap.o with your robot; the
+// arena already does when it compiles Robot_*.cpp.
+//
+//     OccupancyMap map;
+//     map.ensure_size(m_board_row_max, m_board_col_max);   // once boundaries are set
+//     map.update(radar_results);                            // in process_radar_results
+//     if (map.obstacle(r, c)) ...
+class OccupancyMap {
+public:
+    OccupancyMap() = default;
+    OccupancyMap(int rows, int cols) { resize(rows, cols); }
+
+    // Forget everything and cover a rows x cols board
+    void resize(int rows, int cols);
+    // Resize only if the board size changed (cheap to call every turn)
+    void ensure_size(int rows, int cols) { if (rows != m_rows || cols != m_cols) resize(rows, cols); }
+
+    int rows() const { return m_rows; }
+    int cols() const { return m_cols; }
+    bool in_bounds(int r, int c) const { return r >= 0 && r < m_rows && c >= 0 && c < m_cols; }
+
+    // Record one radar scan; cells reported empty or holding a live robot clear their obstacle bits
+    void update(const std::vector<RadarObj>& results);
+    void mark(int r, int c, char type);
+
+    bool seen(int r, int c) const { return in_bounds(r, c) && test(m_seen, r, c); }
+    // Off-board cells count as blocked so planners never step outside
+    bool blocked(int r, int c) const { return !in_bounds(r, c) || test(m_blocked, r, c); }
+    bool hazard(int r, int c) const { return in_bounds(r, c) && test(m_hazard, r, c); }
+    // Anything a robot should not walk into: blocked or hazardous
+    bool obstacle(int r, int c) const { return blocked(r, c) || hazard(r, c); }
+
+    int seen_count() const { return m_seenCount; }
+
+    // Flat indices (r * cols + c) of cells whose blocked/hazard state changed,
+    // in order, since the last resize. Consumers such as PathPlanner remember
+    // how far they have read to catch up incrementally; epoch() changes on resize.
+    const std::vector<int>& changes() const { return m_changes; }
+    uint64_t epoch() const { return m_epoch; }
+
+private:
+    int m_rows = 0;
+    int m_cols = 0;
+    int m_seenCount = 0;
+    uint64_t m_epoch = 0;
+    std::vector<int> m_changes;
+    int m_tileCols = 0;
+
+    using Plane = std::vector<std::unique_ptr<uint64_t[]>>;
+    Plane m_seen;
+    Plane m_blocked;
+    Plane m_hazard;
+
+    size_t tile(int r, int c) const { return static_cast<size_t>(r >> 6) * m_tileCols + (c >> 6); }
+    bool test(const Plane& plane, int r, int c) const {
+        const auto& t = plane[tile(r, c)];
+        return t && ((t[r & 63] >> (c & 63)) & 1u);
+    }
+    bool assign(Plane& plane, int r, int c, bool on);
+};
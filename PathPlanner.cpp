@@ -0,0 +1,288 @@
+#include "PathPlanner.h"
+#include <queue>
+#include <utility>
+#include <functional>
+#include <cstdlib>
+#include <algorithm>
+
+#include "RobotBase.h"
+
+namespace {
+
+// Calls fn(neighborIndex) for every on-board neighbor of idx
+template <typename Fn>
+void for_each_neighbor(int idx, int rows, int cols, Fn&& fn) {
+    int r = idx / cols, c = idx % cols;
+    for (int d = 1; d <= 8; ++d) {
+        int nr = r + directions[d].first, nc = c + directions[d].second;
+        if (nr < 0 || nr >= rows || nc < 0 || nc >= cols) continue;
+        fn(nr * cols + nc);
+    }
+}
+
+int chebyshev(int idx, int row, int col, int cols) {
+    int r = idx / cols, c = idx % cols;
+    return std::max(std::abs(r - row), std::abs(c - col));
+}
+
+} // namespace
+
+// Heap order for open cells: lowest f first, and among equal f the one
+// furthest from the target, which keeps the search on one straight line
+// across open ground instead of filling the whole tie region
+bool PathPlanner::after(const Node& a, const Node& b) {
+    return a.f != b.f ? a.f > b.f : a.g < b.g;
+}
+
+bool PathPlanner::passable(int idx) const {
+    int cols = m_map.cols();
+    return !m_map.obstacle(idx / cols, idx % cols);
+}
+
+int32_t PathPlanner::from_neighbors(const Field& f, int idx) const {
+    int32_t best = unreachable;
+    for_each_neighbor(idx, m_map.rows(), m_map.cols(), [&](int n) {
+        if (f.dist[n] != unreachable && f.dist[n] + 1 < best) best = f.dist[n] + 1;
+    });
+    return best;
+}
+
+PathPlanner::Field& PathPlanner::field_for(int target) {
+    ++m_clock;
+    Field* slot = nullptr;
+    for (auto& f : m_fields) {
+        if (f.target == target) { slot = &f; break; }
+    }
+
+    if (!slot) {
+        if (m_fields.size() < m_cacheSize) {
+            m_fields.emplace_back();
+            slot = &m_fields.back();
+        } else {
+            slot = &m_fields.front();
+            for (auto& f : m_fields) if (f.lastUse < slot->lastUse) slot = &f;
+        }
+        slot->target = target;
+        build(*slot);
+    } else if (slot->epoch != m_map.epoch()) {
+        build(*slot);
+    } else if (slot->changesSeen != m_map.changes().size()) {
+        // a partial field is cheaper to restart than to patch, unless the
+        // changes all lie beyond its frontier where the BFS will see them anyway
+        if (slot->complete) repair(*slot);
+        else if (untouched_by_changes(*slot)) slot->changesSeen = m_map.changes().size();
+        else build(*slot);
+    }
+
+    slot->lastUse = m_clock;
+    return *slot;
+}
+
+// True if no cell changed since the field last looked has a distance or
+// borders one, so the unexplored part of the BFS is still valid
+bool PathPlanner::untouched_by_changes(const Field& f) const {
+    const auto& changes = m_map.changes();
+    for (size_t i = f.changesSeen; i < changes.size(); ++i) {
+        int idx = changes[i];
+        if (f.dist[idx] != unreachable || from_neighbors(f, idx) != unreachable) return false;
+    }
+    return true;
+}
+
+// Start a search outward from the target; expand_to does the actual work
+void PathPlanner::build(Field& f) {
+    int rows = m_map.rows(), cols = m_map.cols();
+    f.epoch = m_map.epoch();
+    f.changesSeen = m_map.changes().size();
+    f.dist.reset(rows, cols);
+    f.open.clear();
+    f.goal = -1;
+    f.complete = false;
+    if (f.target < 0 || f.target >= rows * cols) { f.complete = true; return; }
+
+    f.dist.set(f.target, 0);
+    f.open.push_back({0, 0, f.target});
+}
+
+// Resume the search until the best step from (row, col) is settled. Every
+// stored distance is the length of a real path, so it is never too small; a
+// neighbor's distance is final once nothing still open could undercut it,
+// i.e. the cheapest open f (a lower bound on any unsettled neighbor's
+// distance plus the 1 step to (row, col)) is at least one more than it.
+// Returns false if the expansion budget ran out first.
+bool PathPlanner::expand_to(Field& f, int row, int col) {
+    int rows = m_map.rows(), cols = m_map.cols();
+    int goal = row * cols + col;
+    if (f.goal != goal) {
+        // the open list is ordered toward the previous asker; re-key it
+        f.goal = goal;
+        size_t kept = 0;
+        for (const Node& n : f.open) {
+            if (n.g != f.dist[n.idx]) continue; // superseded by a shorter path
+            f.open[kept++] = Node{n.g + chebyshev(n.idx, row, col, cols), n.g, n.idx};
+        }
+        f.open.resize(kept);
+        std::make_heap(f.open.begin(), f.open.end(), after);
+    }
+
+    int32_t best = unreachable;
+    for (int d = 1; d <= 8; ++d) {
+        int nr = row + directions[d].first, nc = col + directions[d].second;
+        if (m_map.in_bounds(nr, nc)) best = std::min(best, f.dist.at(nr, nc));
+    }
+
+    size_t visited = 0;
+    while (!f.open.empty()) {
+        if (best != unreachable && f.open.front().f > best) return true;
+        if (m_expandBudget && visited == m_expandBudget) return false;
+        // An asker walled into a small pocket would have the search flood
+        // the target's whole side of the wall; check for that once it gets long
+        if (++visited == pocket_cells * 4 && shut_in(row, col, f.target)) return true;
+
+        std::pop_heap(f.open.begin(), f.open.end(), after);
+        Node u = f.open.back();
+        f.open.pop_back();
+        int ur = u.idx / cols, uc = u.idx - ur * cols;
+        if (u.g != f.dist.at(ur, uc)) continue;
+        ++m_expanded;
+
+        int32_t next = u.g + 1;
+        for (int d = 1; d <= 8; ++d) {
+            int nr = ur + directions[d].first, nc = uc + directions[d].second;
+            if (nr < 0 || nr >= rows || nc < 0 || nc >= cols) continue;
+            if (f.dist.at(nr, nc) <= next || m_map.obstacle(nr, nc)) continue;
+            f.dist.set(nr, nc, next);
+            int h = std::max(std::abs(nr - row), std::abs(nc - col));
+            f.open.push_back(Node{next + h, next, nr * cols + nc});
+            std::push_heap(f.open.begin(), f.open.end(), after);
+            if (h == 1) best = std::min(best, next);
+        }
+    }
+
+    // Nothing left open: every reachable cell has its final distance
+    f.complete = true;
+    f.open.clear();
+    f.open.shrink_to_fit();
+    return true;
+}
+
+// True if (row, col) sits in a pocket of at most pocket_cells open cells that
+// does not reach the target. Found by a flood fill from it that gives up
+// (false) once it has seen more cells than that.
+bool PathPlanner::shut_in(int row, int col, int target) const {
+    int rows = m_map.rows(), cols = m_map.cols();
+    std::vector<int> seen{row * cols + col};
+    for (size_t head = 0; head < seen.size(); ++head) {
+        bool reached = false;
+        for_each_neighbor(seen[head], rows, cols, [&](int n) {
+            if (n == target) reached = true;
+            if (reached || !passable(n) || std::find(seen.begin(), seen.end(), n) != seen.end()) return;
+            seen.push_back(n);
+        });
+        if (reached || seen.size() > pocket_cells) return false;
+    }
+    return true;
+}
+
+// Catch up with cells that changed since the field was built. A newly
+// blocked cell invalidates the cells whose every shortest path ran through it,
+// found level by level: a cell one step further out stays valid if another
+// still-valid neighbor supports its distance. Invalidated and newly opened
+// cells are then re-seeded from their neighbors and relaxed in distance order.
+// If the damage is a large part of the board a fresh BFS is cheaper.
+void PathPlanner::repair(Field& f) {
+    int rows = m_map.rows(), cols = m_map.cols();
+    const auto& changes = m_map.changes();
+    size_t rebuildLimit = f.dist.cells() / 8;
+    if (m_expandBudget) rebuildLimit = std::min(rebuildLimit, m_expandBudget);
+
+    std::vector<int> seeds;
+    for (size_t i = f.changesSeen; i < changes.size(); ++i) {
+        int c = changes[i];
+        if (c == f.target) continue;
+
+        if (passable(c)) {
+            if (f.dist[c] == unreachable) seeds.push_back(c);
+            continue;
+        }
+        if (f.dist[c] == unreachable) continue;
+
+        // FIFO order visits whole levels at a time, so when a cell's support
+        // is checked every invalid cell one level closer is already marked
+        std::vector<std::pair<int, int32_t>> invalid{{c, f.dist[c]}};
+        f.dist.set(c, unreachable);
+        for (size_t head = 0; head < invalid.size(); ++head) {
+            auto [u, du] = invalid[head];
+            for_each_neighbor(u, rows, cols, [&](int n) {
+                if (f.dist[n] != du + 1) return;
+                bool supported = false;
+                for_each_neighbor(n, rows, cols, [&](int w) {
+                    if (f.dist[w] == du) supported = true;
+                });
+                if (supported) return;
+                invalid.push_back({n, f.dist[n]});
+                f.dist.set(n, unreachable);
+            });
+            if (invalid.size() > rebuildLimit) { build(f); return; }
+        }
+        for (size_t k = 1; k < invalid.size(); ++k) seeds.push_back(invalid[k].first);
+    }
+    f.changesSeen = changes.size();
+
+    using Item = std::pair<int32_t, int>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> open;
+    for (int s : seeds) {
+        if (!passable(s)) continue;
+        int32_t d = from_neighbors(f, s);
+        if (d < f.dist[s]) {
+            f.dist.set(s, d);
+            open.push({d, s});
+        }
+    }
+    while (!open.empty()) {
+        auto [d, u] = open.top();
+        open.pop();
+        if (d != f.dist[u]) continue;
+        for_each_neighbor(u, rows, cols, [&](int n) {
+            if (!passable(n) || f.dist[n] <= d + 1) return;
+            f.dist.set(n, d + 1);
+            open.push({d + 1, n});
+        });
+    }
+}
+
+PathPlanner::Step PathPlanner::toward(int row, int col, int targetRow, int targetCol, int maxDistance) {
+    Step step;
+    if (!m_map.in_bounds(row, col) || !m_map.in_bounds(targetRow, targetCol)) return step;
+    if (row == targetRow && col == targetCol) { step.remaining = 0; return step; }
+
+    int cols = m_map.cols();
+    Field& f = field_for(targetRow * cols + targetCol);
+    if (!f.complete && !expand_to(f, row, col)) { step.pending = true; return step; }
+
+    // The robot's own cell may be a hazard it is standing on, so look at its neighbors
+    int32_t best = unreachable;
+    for (int d = 1; d <= 8; ++d) {
+        int nr = row + directions[d].first, nc = col + directions[d].second;
+        if (!m_map.in_bounds(nr, nc)) continue;
+        int32_t nd = f.dist[nr * cols + nc];
+        if (nd < best) { best = nd; step.direction = d; }
+    }
+    if (best == unreachable) return step;
+
+    step.remaining = best + 1;
+    step.distance = 1;
+    int r = row + directions[step.direction].first, c = col + directions[step.direction].second;
+    while (step.distance < maxDistance) {
+        int nr = r + directions[step.direction].first, nc = c + directions[step.direction].second;
+        if (!m_map.in_bounds(nr, nc) || f.dist[nr * cols + nc] != f.dist[r * cols + c] - 1) break;
+        r = nr; c = nc;
+        ++step.distance;
+    }
+    return step;
+}
+
+int PathPlanner::distance(int row, int col, int targetRow, int targetCol) {
+    Step s = toward(row, col, targetRow, targetCol, 1);
+    return s.remaining;
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <algorithm>
+
+#include "OccupancyMap.h"
+
+// Distance fields over the robot move model: the 8 directions in directions[]
+// with every step costing 1. A field holds, for each cell, the number of steps
+// to one target cell, addressed by flat index (r * cols + c). Cells the
+// OccupancyMap marks as obstacles are impassable, unseen cells are assumed open.
+//
+// A field is grown lazily, toward whoever asks: an A* search outward from the
+// target, ordered by the Chebyshev distance to the asking cell, runs only
+// until that cell's best step is settled. On open ground it visits a narrow
+// band along the straight line, so a query costs about as many cells as the
+// distance; a target that moves every turn (a new field each time) stays
+// cheap on a 1000x1000 board. Later queries from other cells resume the same
+// search. An optional expansion budget caps the cells one query may visit; a
+// query that runs out reports the step as pending and the next one carries on.
+// Fields are cached per target (least recently used is dropped). A query for
+// a cached target whose field already reaches the asking cell is O(1) plus the
+// move distance, so walking to a fixed goal pays for one search. Finished
+// fields are repaired incrementally from the map's change log when new
+// obstacles are seen.
+//
+//     PathPlanner planner(map);
+//     auto step = planner.toward(row, col, target_row, target_col, get_move_speed());
+//     if (step.direction != 0) { move_direction = step.direction; move_distance = step.distance; }
+class PathPlanner {
+public:
+    static constexpr int32_t unreachable = INT32_MAX;
+
+    struct Step {
+        int direction = 0;   // 1-8 as in directions[]; 0 when unreachable or already there
+        int distance = 0;    // straight steps worth taking in that direction
+        int remaining = -1;  // steps from the current cell to the target, -1 if unreachable
+        bool pending = false; // expansion budget ran out before the search got here
+    };
+
+    // expandBudget of 0 lets a query search as far as it needs to
+    explicit PathPlanner(const OccupancyMap& map, size_t cacheSize = 4, size_t expandBudget = 0)
+        : m_map(map), m_cacheSize(cacheSize ? cacheSize : 1), m_expandBudget(expandBudget) {}
+
+    // Best move from (row, col) toward (targetRow, targetCol), at most maxDistance steps
+    Step toward(int row, int col, int targetRow, int targetCol, int maxDistance);
+
+    // Steps from (row, col) to the target, or -1 if it cannot be reached (or is still pending)
+    int distance(int row, int col, int targetRow, int targetCol);
+
+    // Cells expanded by all queries so far, a measure of the work they did
+    uint64_t expanded() const { return m_expanded; }
+
+private:
+    // Per-cell distances in 16x16 tiles, allocated the first time a cell in
+    // them is given a distance; the rest read unreachable. A field that only
+    // grew along a path stays small on a huge board, whichever way it runs.
+    class Distances {
+    public:
+        void reset(int rows, int cols) {
+            m_cols = cols;
+            m_tileCols = (cols + tile_size - 1) >> tile_shift;
+            m_cells = static_cast<size_t>(rows) * cols;
+            m_tiles.clear();
+            m_tiles.resize(static_cast<size_t>((rows + tile_size - 1) >> tile_shift) * m_tileCols);
+        }
+        size_t cells() const { return m_cells; }
+        int32_t operator[](int idx) const { return at(idx / m_cols, idx % m_cols); }
+        void set(int idx, int32_t d) { set(idx / m_cols, idx % m_cols, d); }
+
+        int32_t at(int r, int c) const {
+            const auto& tile = m_tiles[tile_of(r, c)];
+            return tile ? tile[offset_of(r, c)] : unreachable;
+        }
+        void set(int r, int c, int32_t d) {
+            auto& tile = m_tiles[tile_of(r, c)];
+            if (!tile) {
+                if (d == unreachable) return;
+                tile.reset(new int32_t[tile_size * tile_size]);
+                std::fill_n(tile.get(), tile_size * tile_size, unreachable);
+            }
+            tile[offset_of(r, c)] = d;
+        }
+
+    private:
+        static constexpr int tile_shift = 4;
+        static constexpr int tile_size = 1 << tile_shift;
+        int m_cols = 1;
+        int m_tileCols = 0;
+        size_t m_cells = 0;
+        std::vector<std::unique_ptr<int32_t[]>> m_tiles;
+
+        size_t tile_of(int r, int c) const {
+            return static_cast<size_t>(r >> tile_shift) * m_tileCols + (c >> tile_shift);
+        }
+        static int offset_of(int r, int c) {
+            return ((r & (tile_size - 1)) << tile_shift) | (c & (tile_size - 1));
+        }
+    };
+
+    // An open cell: f = g + Chebyshev distance to the field's current goal
+    struct Node {
+        int32_t f;
+        int32_t g;
+        int idx;
+    };
+
+    struct Field {
+        int target = -1;
+        int goal = -1;            // cell the open list is ordered toward
+        uint64_t epoch = 0;
+        size_t changesSeen = 0;
+        uint64_t lastUse = 0;
+        Distances dist;
+        std::vector<Node> open;   // A* frontier as a heap, kept so the search can resume
+        bool complete = false;
+    };
+
+    const OccupancyMap& m_map;
+    size_t m_cacheSize;
+    size_t m_expandBudget;
+    uint64_t m_clock = 0;
+    uint64_t m_expanded = 0;
+    std::vector<Field> m_fields;
+
+    static constexpr size_t pocket_cells = 64;
+
+    static bool after(const Node& a, const Node& b);
+    bool shut_in(int row, int col, int target) const;
+    Field& field_for(int target);
+    void build(Field& f);
+    bool expand_to(Field& f, int row, int col);
+    bool untouched_by_changes(const Field& f) const;
+    void repair(Field& f);
+    bool passable(int idx) const;
+    int32_t from_neighbors(const Field& f, int idx) const;
+};
@@ -2,6 +2,10 @@
 #include <vector>
 #include <string>
 #include <optional>
+#include <array>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
 
 // Board cell types encoded as chars, matching RadarObj conventions
 // 'X' dead robot, 'R' live robot, 'M' mound, 'F' flamethrower, 'P' pit, '.' empty
@@ -9,78 +13,125 @@ struct BoardCell {
     char type = '.';
     // If robot-occupied, index in robot list; otherwise -1
     int robotIndex = -1;
-    std::string display;
 };
 
+// The grid is cut into fixed-size square tiles that are only allocated once
+// something is placed in them and freed again when they empty out, so memory
+// follows the occupied area rather than rows * cols. Copies of a board share
+// tiles and clone one on its first write, which keeps snapshots cheap.
+//
+// The board also keeps a Zobrist hash of its contents: every write XORs out
+// the old cell's key and XORs in the new one, so hash() is always current
+// without rescanning the board. Keys are computed from (cell, contents)
+// instead of looked up in a table, which would be as large as the board.
 class PlayingBoard {
 public:
+    static constexpr int tile_shift = 6;
+    static constexpr int tile_size = 1 << tile_shift; // 64x64 cells per tile
+
     PlayingBoard(int rows, int cols)
-        : m_rows(rows), m_cols(cols), m_grid(rows, std::vector<BoardCell>(cols)) {}
+        : m_rows(rows), m_cols(cols),
+          m_tileRows((rows + tile_size - 1) >> tile_shift),
+          m_tileCols((cols + tile_size - 1) >> tile_shift),
+          m_tiles(static_cast<size_t>(m_tileRows) * m_tileCols) {}
 
     int rows() const { return m_rows; }
     int cols() const { return m_cols; }
 
     bool in_bounds(int r, int c) const { return r >= 0 && r < m_rows && c >= 0 && c < m_cols; }
 
-    BoardCell& at(int r, int c) { return m_grid[r][c]; }
-    const BoardCell& at(int r, int c) const { return m_grid[r][c]; }
+    // Flat cell numbering for callers that keep cell lists; index = r * cols + c
+    int index(int r, int c) const { return r * m_cols + c; }
+    int row_of(int idx) const { return idx / m_cols; }
+    int col_of(int idx) const { return idx % m_cols; }
+
+    // Tile grid; tile_of gives the tile holding a cell, numbered row-major
+    int tile_rows() const { return m_tileRows; }
+    int tile_cols() const { return m_tileCols; }
+    int tile_of(int r, int c) const { return (r >> tile_shift) * m_tileCols + (c >> tile_shift); }
+    size_t allocated_tiles() const {
+        size_t n = 0;
+        for (const auto& t : m_tiles) if (t) ++n;
+        return n;
+    }
+
+    // Cells in unallocated tiles read as empty. Writes go through the helpers below.
+    const BoardCell& at(int r, int c) const {
+        static const BoardCell empty;
+        const Tile* t = m_tiles[tile_of(r, c)].get();
+        return t ? t->cells[offset(r, c)] : empty;
+    }
 
     void clear() {
-        for (auto& row : m_grid) {
-            for (auto& cell : row) {
-                cell.type = '.';
-                cell.robotIndex = -1;
-            }
-        }
+        for (auto& t : m_tiles) t.reset();
+        m_hash = 0;
+    }
+
+    // Equal contents give equal hashes; an empty board hashes to 0
+    uint64_t hash() const { return m_hash; }
+
+    // splitmix64 finalizer over the cell index, type and robot; empty cells are 0
+    static uint64_t cell_key(int idx, char type, int robotIndex) {
+        if (type == '.') return 0;
+        uint64_t x = static_cast<uint64_t>(static_cast<uint32_t>(idx)) << 32 ^
+                     static_cast<uint64_t>(static_cast<unsigned char>(type)) << 24 ^
+                     static_cast<uint32_t>(robotIndex + 1);
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
     }
 
     // Simple placement helpers
     bool place_obstacle(int r, int c, char kind) {
         if (!in_bounds(r, c)) return false;
         if (kind != 'M' && kind != 'F' && kind != 'P') return false;
-        auto& cell = at(r, c);
+        const auto& cell = at(r, c);
         if (cell.type == 'R' || cell.type == 'X') return false; // no obstacle on robots
-        cell.type = kind;
-        cell.robotIndex = -1;
+        set(r, c, kind, -1);
         return true;
     }
 
     bool place_robot(int r, int c, int robotIndex, bool alive = true) {
         if (!in_bounds(r, c)) return false;
-        
-        auto& cell = at(r, c);
-        if (cell.type != '.') return false; // only empty
-        cell.type = alive ? 'R' : 'X';
-        cell.robotIndex = robotIndex;
+
+        if (at(r, c).type != '.') return false; // only empty
+        set(r, c, alive ? 'R' : 'X', robotIndex);
         return true;
     }
 
     void set_dead(int r, int c) {
         if (!in_bounds(r, c)) return;
-        auto& cell = at(r, c);
-        if (cell.type == 'R') cell.type = 'X';
+        const auto& cell = at(r, c);
+        if (cell.type == 'R') set(r, c, 'X', cell.robotIndex);
     }
 
     void vacate(int r, int c) {
         if (!in_bounds(r, c)) return;
-        auto& cell = at(r, c);
-        cell.type = '.';
-        cell.robotIndex = -1;
+        set(r, c, '.', -1);
     }
 
-    std::string render() const {
+    std::string render() const { return render(0, 0, m_rows, m_cols); }
+
+    // Viewport of rows x cols cells from (top, left), clipped to the board and
+    // labelled with board coordinates
+    std::string render(int top, int left, int rows, int cols) const {
+        int bottom = std::min(m_rows, top + rows), right = std::min(m_cols, left + cols);
+        top = std::max(0, top);
+        left = std::max(0, left);
+
         std::string out;
         // header
         out += "    ";
-        for (int c = 0; c < m_cols; ++c) {
+        for (int c = left; c < right; ++c) {
             out += (c < 10 ? " " : "") + std::to_string(c) + " ";
         }
         out += "\n";
-        for (int r = 0; r < m_rows; ++r) {
+        for (int r = top; r < bottom; ++r) {
             out += (r < 10 ? " " : "") + std::to_string(r) + "  ";
 
-            for (int c = 0; c < m_cols; ++c) {
-                out += m_grid[r][c].type;
+            for (int c = left; c < right; ++c) {
+                out += at(r, c).type;
                 out += "  ";
             }
             
@@ -90,7 +141,72 @@ public:
     }
 
 private:
+    template <int Rows, int Cols> friend class BoardView;
+
+    struct Tile {
+        std::array<BoardCell, tile_size * tile_size> cells;
+        int used = 0; // non-empty cells; the tile is dropped when it reaches 0
+    };
+
     int m_rows;
     int m_cols;
-    std::vector<std::vector<BoardCell>> m_grid;
+    int m_tileRows;
+    int m_tileCols;
+    std::vector<std::shared_ptr<Tile>> m_tiles;
+    uint64_t m_hash = 0;
+
+    static int offset(int r, int c) {
+        return ((r & (tile_size - 1)) << tile_shift) | (c & (tile_size - 1));
+    }
+
+    void set(int r, int c, char type, int robotIndex) {
+        auto& slot = m_tiles[tile_of(r, c)];
+        if (!slot) {
+            if (type == '.') return;
+            slot = std::make_shared<Tile>();
+        } else if (slot.use_count() > 1) {
+            slot = std::make_shared<Tile>(*slot); // shared with a copy: clone before writing
+        }
+
+        BoardCell& cell = slot->cells[offset(r, c)];
+        m_hash ^= cell_key(index(r, c), cell.type, cell.robotIndex) ^ cell_key(index(r, c), type, robotIndex);
+        slot->used += (type != '.') - (cell.type != '.');
+        cell.type = type;
+        cell.robotIndex = robotIndex;
+        if (slot->used == 0) slot.reset();
+    }
+};
+
+// Read-only view of a board whose size is fixed at compile time (Rows and
+// Cols > 0): bounds checks, tile lookups and trip counts over it fold to
+// constants. BoardView<0, 0> reads the size from the board and works for any
+// board. The view must only be used on a board of that size.
+template <int Rows, int Cols>
+class BoardView {
+public:
+    explicit BoardView(const PlayingBoard& board) : m_board(board) {}
+
+    int rows() const {
+        if constexpr (Rows > 0) return Rows;
+        else return m_board.m_rows;
+    }
+    int cols() const {
+        if constexpr (Cols > 0) return Cols;
+        else return m_board.m_cols;
+    }
+    int tile_cols() const { return (cols() + PlayingBoard::tile_size - 1) >> PlayingBoard::tile_shift; }
+
+    bool in_bounds(int r, int c) const {
+        return static_cast<unsigned>(r) < static_cast<unsigned>(rows()) &&
+               static_cast<unsigned>(c) < static_cast<unsigned>(cols());
+    }
+
+    // Same as PlayingBoard::at(r, c).type; (r, c) must be in bounds
+    char type_at(int r, int c) const {
+        const auto* t = m_board.m_tiles[(r >> PlayingBoard::tile_shift) * tile_cols() + (c >> PlayingBoard::tile_shift)].get();
+        return t ? t->cells[PlayingBoard::offset(r, c)].type : '.';
+    }
+
+private:
+    const PlayingBoard& m_board;
 };
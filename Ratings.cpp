@@ -0,0 +1,181 @@
+#include "Ratings.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+constexpr uint32_t file_magic = 0x4f4c4552; // "RELO"
+
+double expected(double ra, double rb) {
+    return 1.0 / (1.0 + std::pow(10.0, (rb - ra) / 400.0));
+}
+
+// How much a game between two robots would tell us: outcome uncertainty
+// p(1-p), weighted up for robots with few games (including pending ones)
+double information(double ra, int ga, double rb, int gb) {
+    double p = expected(ra, rb);
+    return p * (1.0 - p) * (1.0 / std::sqrt(1.0 + ga) + 1.0 / std::sqrt(1.0 + gb));
+}
+
+} // namespace
+
+size_t RatingTable::index_of(const std::string& name) {
+    auto it = m_index.find(name);
+    if (it != m_index.end()) return it->second;
+    m_entries.push_back({name, m_initial});
+    m_index.emplace(name, m_entries.size() - 1);
+    return m_entries.size() - 1;
+}
+
+void RatingTable::add(const std::string& name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    index_of(name);
+}
+
+void RatingTable::record(const MatchResult& result) {
+    size_t n = result.robots.size();
+    if (n == 0) return;
+
+    std::vector<int> place = result.places();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<size_t> ids(n);
+    for (size_t i = 0; i < n; ++i) ids[i] = index_of(result.robots[i]);
+
+    std::vector<double> delta(n, 0.0);
+    double k = n > 1 ? m_k / static_cast<double>(n - 1) : 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i + 1; j < n; ++j) {
+            double score = place[i] < place[j] ? 1.0 : place[i] == place[j] ? 0.5 : 0.0;
+            double e = expected(m_entries[ids[i]].rating, m_entries[ids[j]].rating);
+            delta[i] += k * (score - e);
+            delta[j] -= k * (score - e);
+        }
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        Entry& en = m_entries[ids[i]];
+        en.rating += delta[i];
+        ++en.games;
+        if (en.pending > 0) --en.pending;
+    }
+}
+
+std::vector<std::string> RatingTable::pick_match(size_t players, std::mt19937& rng, bool adaptive) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::string> out;
+    if (players == 0 || players > m_entries.size()) return out;
+
+    std::vector<size_t> chosen;
+    if (!adaptive) {
+        std::vector<size_t> all(m_entries.size());
+        std::iota(all.begin(), all.end(), 0);
+        std::shuffle(all.begin(), all.end(), rng);
+        chosen.assign(all.begin(), all.begin() + players);
+    } else {
+        // Greedy: start from the least played robot (random among ties), then
+        // add whoever a game against the chosen ones would tell us most about
+        auto load = [&](size_t i) { return m_entries[i].games + m_entries[i].pending; };
+        std::vector<size_t> order(m_entries.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), rng);
+        chosen.push_back(*std::min_element(order.begin(), order.end(),
+                                           [&](size_t a, size_t b) { return load(a) < load(b); }));
+
+        while (chosen.size() < players) {
+            double best = -1.0;
+            size_t pick = 0;
+            for (size_t i : order) {
+                if (std::find(chosen.begin(), chosen.end(), i) != chosen.end()) continue;
+                double info = 0.0;
+                for (size_t c : chosen) {
+                    info += information(m_entries[i].rating, load(i), m_entries[c].rating, load(c));
+                }
+                if (info > best) { best = info; pick = i; }
+            }
+            chosen.push_back(pick);
+        }
+    }
+
+    for (size_t i : chosen) {
+        ++m_entries[i].pending;
+        out.push_back(m_entries[i].name);
+    }
+    return out;
+}
+
+void RatingTable::release(const std::vector<std::string>& names) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& name : names) {
+        auto it = m_index.find(name);
+        if (it != m_index.end() && m_entries[it->second].pending > 0) --m_entries[it->second].pending;
+    }
+}
+
+std::vector<RatingTable::Standing> RatingTable::standings() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<Standing> out;
+    for (const auto& e : m_entries) out.push_back({e.name, e.rating, e.games});
+    std::sort(out.begin(), out.end(), [](const Standing& a, const Standing& b) { return a.rating > b.rating; });
+    return out;
+}
+
+bool RatingTable::save(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        if (!f) { std::cerr << "Cannot write ratings to " << tmp << "\n"; return false; }
+
+        auto put = [&](const auto& v) { f.write(reinterpret_cast<const char*>(&v), sizeof(v)); };
+        put(file_magic);
+        put(static_cast<uint32_t>(m_entries.size()));
+        for (const auto& e : m_entries) {
+            uint8_t len = static_cast<uint8_t>(std::min<size_t>(e.name.size(), 255));
+            put(len);
+            f.write(e.name.data(), len);
+            put(static_cast<float>(e.rating));
+            put(static_cast<uint32_t>(e.games));
+        }
+        if (!f) { std::cerr << "Cannot write ratings to " << tmp << "\n"; return false; }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::cerr << "Cannot replace " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool RatingTable::load(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+
+    auto get = [&](auto& v) { return static_cast<bool>(f.read(reinterpret_cast<char*>(&v), sizeof(v))); };
+    uint32_t magic = 0, count = 0;
+    if (!get(magic) || magic != file_magic || !get(count)) {
+        std::cerr << path << " is not a ratings file\n";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (uint32_t i = 0; i < count; ++i) {
+        uint8_t len = 0;
+        float rating = 0;
+        uint32_t games = 0;
+        std::string name(255, '\0');
+        if (!get(len) || !f.read(name.data(), len) || !get(rating) || !get(games)) {
+            std::cerr << path << " is truncated\n";
+            return false;
+        }
+        name.resize(len);
+        Entry& e = m_entries[index_of(name)];
+        e.rating = rating;
+        e.games = static_cast<int>(games);
+    }
+    return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+
+#include "Arena.h"
+
+// Elo ratings for robots, updated from match results. A match with several
+// robots is scored as every pair playing a head-to-head game decided by
+// finishing order: survivors share first place, then robots in reverse order
+// of elimination. All methods are safe to call from several threads.
+//
+// The table also schedules matches: pick_match() chooses the robots whose
+// result is least predictable given the current ratings, favouring robots
+// with few games, which settles the ratings with far fewer matches than a
+// fixed round-robin.
+class RatingTable {
+public:
+    struct Standing {
+        std::string name;
+        double rating = 0;
+        int games = 0;
+    };
+
+    explicit RatingTable(double k = 32.0, double initial = 1500.0) : m_k(k), m_initial(initial) {}
+
+    // Registers a robot at the initial rating; known robots are left alone
+    void add(const std::string& name);
+
+    // Applies one match; robots not registered yet are added first
+    void record(const MatchResult& result);
+
+    // Picks `players` registered robots for the next match and holds them as
+    // pending until record() or release() sees them. Empty if too few robots.
+    // With adaptive off the pick is uniformly random, for comparison.
+    std::vector<std::string> pick_match(size_t players, std::mt19937& rng, bool adaptive = true);
+    void release(const std::vector<std::string>& names);
+
+    // Everyone, best first
+    std::vector<Standing> standings() const;
+
+    // Compact binary file: magic, count, then name/rating/games per robot.
+    // save() writes a temporary file and renames it over the old one.
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+private:
+    struct Entry {
+        std::string name;
+        double rating;
+        int games = 0;
+        int pending = 0; // scheduled but not recorded yet
+    };
+
+    double m_k;
+    double m_initial;
+    mutable std::mutex m_mutex;
+    std::vector<Entry> m_entries;
+    std::unordered_map<std::string, size_t> m_index;
+
+    size_t index_of(const std::string& name); // adds unknown names; caller holds the lock
+};
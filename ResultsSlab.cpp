@@ -0,0 +1,103 @@
+#include "ResultsSlab.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <sys/mman.h>
+
+ResultsSlab::ResultsSlab(size_t regions, size_t slotsPerRegion, size_t robotsPerMatch)
+    : m_regions(regions), m_slots(slotsPerRegion), m_robots(robotsPerMatch) {
+    m_slotBytes = sizeof(SlotHeader) + m_robots * (sizeof(SlotRobot) + sizeof(int32_t));
+    m_slotBytes = (m_slotBytes + 7) & ~size_t{7};
+    m_bytes = m_regions * m_slots * m_slotBytes;
+    if (m_bytes == 0) return;
+
+    void* p = mmap(nullptr, m_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        std::cerr << "Cannot map " << m_bytes << " bytes for the results slab\n";
+        return;
+    }
+    m_data = static_cast<unsigned char*>(p);
+    for (size_t r = 0; r < m_regions; ++r) clear(r);
+}
+
+ResultsSlab::~ResultsSlab() {
+    if (m_data) munmap(m_data, m_bytes);
+}
+
+ResultsSlab::SlotHeader* ResultsSlab::slot(size_t region, size_t slot) const {
+    return reinterpret_cast<SlotHeader*>(m_data + (region * m_slots + slot) * m_slotBytes);
+}
+
+void ResultsSlab::clear(size_t region) {
+    for (size_t s = 0; s < m_slots; ++s) slot(region, s)->ready.store(0, std::memory_order_relaxed);
+}
+
+bool ResultsSlab::put(size_t region, size_t s, int matchNo, const MatchResult& r,
+                      const std::vector<RobotFactoryEntry>& roster) {
+    if (!m_data || region >= m_regions || s >= m_slots) return false;
+    size_t n = r.robots.size();
+    if (n > m_robots || r.eliminated.size() > m_robots) return false;
+
+    SlotHeader* h = slot(region, s);
+    auto* rows = reinterpret_cast<SlotRobot*>(h + 1);
+    auto* eliminated = reinterpret_cast<int32_t*>(rows + m_robots);
+
+    std::vector<bool> alive(n, false);
+    for (int idx : r.survivors) {
+        if (idx >= 0 && static_cast<size_t>(idx) < n) alive[idx] = true;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        auto it = std::find_if(roster.begin(), roster.end(), [&](const RobotFactoryEntry& e) { return e.name == r.robots[i]; });
+        if (it == roster.end()) return false;
+        rows[i] = SlotRobot{static_cast<uint32_t>(it - roster.begin()), alive[i] ? 1u : 0u,
+                            i < r.damageDealt.size() ? r.damageDealt[i] : 0,
+                            i < r.damageTaken.size() ? r.damageTaken[i] : 0,
+                            i < r.cpuNs.size() ? r.cpuNs[i] : 0,
+                            i < r.heapPeakBytes.size() ? r.heapPeakBytes[i] : 0};
+    }
+    for (size_t i = 0; i < r.eliminated.size(); ++i) eliminated[i] = r.eliminated[i];
+
+    h->matchNo = matchNo;
+    h->winner = r.winner;
+    h->rounds = r.rounds;
+    h->seed = r.seed;
+    h->endReason = static_cast<int32_t>(r.endReason);
+    h->robots = static_cast<uint32_t>(n);
+    h->eliminated = static_cast<uint32_t>(r.eliminated.size());
+    h->configHash = r.configHash;
+    h->stateHash = r.stateHash;
+    h->ready.store(1, std::memory_order_release);
+    return true;
+}
+
+bool ResultsSlab::take(size_t region, size_t s, const std::vector<RobotFactoryEntry>& roster, int& matchNo,
+                       MatchResult& r) const {
+    if (!m_data || region >= m_regions || s >= m_slots) return false;
+    const SlotHeader* h = slot(region, s);
+    if (h->ready.load(std::memory_order_acquire) != 1) return false;
+    if (h->robots > m_robots || h->eliminated > m_robots) return false;
+
+    const auto* rows = reinterpret_cast<const SlotRobot*>(h + 1);
+    const auto* eliminated = reinterpret_cast<const int32_t*>(rows + m_robots);
+
+    r = MatchResult{};
+    matchNo = h->matchNo;
+    r.winner = h->winner;
+    r.rounds = h->rounds;
+    r.seed = h->seed;
+    r.endReason = static_cast<EndReason>(h->endReason);
+    r.configHash = h->configHash;
+    r.stateHash = h->stateHash;
+    for (uint32_t i = 0; i < h->robots; ++i) {
+        const SlotRobot& row = rows[i];
+        if (row.roster >= roster.size()) return false;
+        r.robots.push_back(roster[row.roster].name);
+        if (row.alive) r.survivors.push_back(static_cast<int>(i));
+        r.damageDealt.push_back(row.damageDealt);
+        r.damageTaken.push_back(row.damageTaken);
+        r.cpuNs.push_back(row.cpuNs);
+        r.heapPeakBytes.push_back(static_cast<size_t>(row.heapPeakBytes));
+    }
+    r.eliminated.assign(eliminated, eliminated + h->eliminated);
+    return true;
+}
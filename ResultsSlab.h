@@ -0,0 +1,78 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#include "Arena.h"
+
+// Shared-memory slots that forked tournament workers report match results
+// through. The memory is mapped MAP_SHARED before the workers are forked, so
+// a worker writes straight into memory the parent reads; nothing goes
+// through a pipe or a file.
+//
+// The slab is a fixed set of regions, one per running worker, each with a
+// slot per match of the worker's batch. The parent hands a free region to
+// each new worker and takes it back once the worker has exited and its slots
+// have been read. A slot is only marked ready after it is completely written, so a
+// worker that dies mid-match leaves its earlier results readable and the rest
+// empty. Robots are stored as their index in the roster the parent loaded,
+// which the worker shares.
+class ResultsSlab {
+public:
+    ResultsSlab(size_t regions, size_t slotsPerRegion, size_t robotsPerMatch);
+    ~ResultsSlab();
+
+    ResultsSlab(const ResultsSlab&) = delete;
+    ResultsSlab& operator=(const ResultsSlab&) = delete;
+
+    bool ok() const { return m_data != nullptr; }
+    size_t regions() const { return m_regions; }
+    size_t slots_per_region() const { return m_slots; }
+
+    // Empties a region for its next worker
+    void clear(size_t region);
+
+    // Worker side. False if the result does not fit the slot or names a
+    // robot that is not in roster.
+    bool put(size_t region, size_t slot, int matchNo, const MatchResult& r, const std::vector<RobotFactoryEntry>& roster);
+
+    // Parent side. False if the slot was never completed.
+    bool take(size_t region, size_t slot, const std::vector<RobotFactoryEntry>& roster, int& matchNo, MatchResult& r) const;
+
+private:
+    struct SlotHeader {
+        std::atomic<uint32_t> ready;
+        int32_t matchNo;
+        int32_t winner;
+        int32_t rounds;
+        uint32_t seed;
+        int32_t endReason;
+        uint32_t robots;
+        uint32_t eliminated;
+        uint64_t configHash;
+        uint64_t stateHash;
+    };
+
+    // one per robot in the match, followed by the eliminated list (int32 each)
+    struct SlotRobot {
+        uint32_t roster;
+        uint32_t alive;
+        int32_t damageDealt;
+        int32_t damageTaken;
+        int64_t cpuNs;
+        uint64_t heapPeakBytes;
+    };
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "slot flags are shared between processes");
+
+    unsigned char* m_data = nullptr;
+    size_t m_bytes = 0;
+    size_t m_regions;
+    size_t m_slots;
+    size_t m_robots;     // most robots a slot holds
+    size_t m_slotBytes;
+
+    SlotHeader* slot(size_t region, size_t slot) const;
+};
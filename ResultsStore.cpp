@@ -0,0 +1,295 @@
+#include "ResultsStore.h"
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+
+namespace results {
+
+namespace {
+
+size_t pad8(size_t n) { return (n + 7) & ~size_t{7}; }
+
+template <typename T>
+void put_column(std::vector<unsigned char>& buf, const std::vector<T>& col) {
+    size_t at = buf.size();
+    buf.resize(at + pad8(col.size() * sizeof(T)), 0);
+    if (!col.empty()) std::memcpy(buf.data() + at, col.data(), col.size() * sizeof(T));
+}
+
+// Points col at the next column of count values and moves past it
+template <typename T>
+void take_column(const unsigned char*& p, size_t count, const T*& col) {
+    col = reinterpret_cast<const T*>(p);
+    p += pad8(count * sizeof(T));
+}
+
+// FNV-1a over 64-bit words, folding the high half down after each so every
+// bit reaches the result; blocks are padded to 8 bytes throughout
+uint64_t checksum(const unsigned char* p, size_t bytes) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i + 8 <= bytes; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, p + i, sizeof(w));
+        h = (h ^ w) * 1099511628211ULL;
+        h ^= h >> 32;
+    }
+    return h;
+}
+
+// Size a block with this header must have: the sections it describes, laid
+// out as the writer lays them out
+uint64_t expected_bytes(const BlockHeader& h) {
+    return sizeof(BlockHeader) + h.namesBytes + pad8(h.matches * uint64_t{8}) + 4 * pad8(h.matches * uint64_t{4}) +
+           6 * pad8(h.entries * uint64_t{4}) + sizeof(uint64_t);
+}
+
+} // namespace
+
+Writer::Writer(const std::string& path, size_t blockMatches)
+    : m_path(path), m_blockMatches(std::max<size_t>(1, blockMatches)) {
+    m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (m_fd < 0) {
+        std::cerr << "Cannot open results file " << path << "\n";
+        return;
+    }
+    if (flock(m_fd, LOCK_EX | LOCK_NB) != 0) {
+        std::cerr << "Results file " << path << " is already open for writing\n";
+        ::close(m_fd);
+        m_fd = -1;
+        return;
+    }
+
+    // Continue the existing dictionary so robot ids stay stable across runs,
+    // and cut off a block torn by a crash so the next one follows a whole one
+    Reader existing(path);
+    bool usable = existing.ok() && !existing.newer_format();
+    if (usable && existing.valid_bytes() < existing.file_bytes()) {
+        usable = ::ftruncate(m_fd, static_cast<off_t>(existing.valid_bytes())) == 0;
+        if (usable) std::cerr << "Truncated results file " << path << " to its last whole block\n";
+    }
+    if (!usable) {
+        std::cerr << "Not appending to results file " << path << "\n";
+        ::close(m_fd);
+        m_fd = -1;
+        return;
+    }
+    for (size_t i = 0; i < existing.names().size(); ++i) {
+        m_ids.emplace(existing.names()[i], static_cast<uint32_t>(i));
+    }
+}
+
+Writer::~Writer() {
+    flush();
+    if (m_fd >= 0) ::close(m_fd);
+}
+
+uint32_t Writer::id_of(const std::string& name) {
+    auto it = m_ids.find(name);
+    if (it != m_ids.end()) return it->second;
+    uint32_t id = static_cast<uint32_t>(m_ids.size());
+    m_ids.emplace(name, id);
+    m_newNames.push_back(name);
+    return id;
+}
+
+void Writer::append(const MatchResult& r) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<int> place = r.places();
+
+    m_configHash.push_back(r.configHash);
+    m_seed.push_back(r.seed);
+    m_rounds.push_back(static_cast<uint32_t>(r.rounds));
+    m_winner.push_back(r.winner >= 0 ? static_cast<int32_t>(id_of(r.robots[r.winner])) : -1);
+    m_entries.push_back(static_cast<uint32_t>(r.robots.size()));
+
+    for (size_t i = 0; i < r.robots.size(); ++i) {
+        m_robot.push_back(id_of(r.robots[i]));
+        m_place.push_back(static_cast<uint32_t>(place[i]));
+        m_dealt.push_back(i < r.damageDealt.size() ? r.damageDealt[i] : 0);
+        m_taken.push_back(i < r.damageTaken.size() ? r.damageTaken[i] : 0);
+        m_cpuUs.push_back(i < r.cpuNs.size() ? static_cast<uint32_t>(std::min<long long>(r.cpuNs[i] / 1000, UINT32_MAX)) : 0);
+        m_heapKb.push_back(i < r.heapPeakBytes.size() ? static_cast<uint32_t>(std::min<size_t>(r.heapPeakBytes[i] / 1024, UINT32_MAX)) : 0);
+    }
+
+    if (m_seed.size() >= m_blockMatches) flush_locked();
+}
+
+bool Writer::flush() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return flush_locked();
+}
+
+bool Writer::sync() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!flush_locked()) return false;
+    if (::fdatasync(m_fd) != 0) {
+        std::cerr << "Cannot sync results file " << m_path << "\n";
+        return false;
+    }
+    return true;
+}
+
+uint64_t Writer::file_size() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    struct stat st{};
+    if (m_fd < 0 || ::fstat(m_fd, &st) != 0) return 0;
+    return static_cast<uint64_t>(st.st_size);
+}
+
+bool Writer::flush_locked() {
+    if (m_seed.empty() || m_fd < 0) return m_fd >= 0;
+
+    std::vector<unsigned char> buf(sizeof(BlockHeader));
+    size_t namesStart = buf.size();
+    for (const auto& name : m_newNames) {
+        uint16_t len = static_cast<uint16_t>(std::min<size_t>(name.size(), UINT16_MAX));
+        buf.insert(buf.end(), reinterpret_cast<const unsigned char*>(&len),
+                   reinterpret_cast<const unsigned char*>(&len) + sizeof(len));
+        buf.insert(buf.end(), name.begin(), name.begin() + len);
+    }
+    buf.resize(namesStart + pad8(buf.size() - namesStart), 0);
+    size_t namesBytes = buf.size() - namesStart;
+
+    put_column(buf, m_configHash);
+    put_column(buf, m_seed);
+    put_column(buf, m_rounds);
+    put_column(buf, m_winner);
+    put_column(buf, m_entries);
+    put_column(buf, m_robot);
+    put_column(buf, m_place);
+    put_column(buf, m_dealt);
+    put_column(buf, m_taken);
+    put_column(buf, m_cpuUs);
+    put_column(buf, m_heapKb);
+
+    BlockHeader h{block_magic, format_version, static_cast<uint32_t>(m_seed.size()),
+                  static_cast<uint32_t>(m_robot.size()), static_cast<uint32_t>(m_newNames.size()),
+                  static_cast<uint32_t>(namesBytes), buf.size() + sizeof(uint64_t)};
+    std::memcpy(buf.data(), &h, sizeof(h));
+    uint64_t sum = checksum(buf.data(), buf.size());
+    buf.insert(buf.end(), reinterpret_cast<const unsigned char*>(&sum),
+               reinterpret_cast<const unsigned char*>(&sum) + sizeof(sum));
+
+    // One write per block, so a crash tears at most the last one
+    ssize_t n = ::write(m_fd, buf.data(), buf.size());
+    if (n != static_cast<ssize_t>(buf.size())) {
+        std::cerr << "Short write to results file " << m_path << "\n";
+        return false;
+    }
+
+    m_newNames.clear();
+    m_configHash.clear();
+    m_seed.clear();
+    m_rounds.clear();
+    m_winner.clear();
+    m_entries.clear();
+    m_robot.clear();
+    m_place.clear();
+    m_dealt.clear();
+    m_taken.clear();
+    m_cpuUs.clear();
+    m_heapKb.clear();
+    return true;
+}
+
+Reader::Reader(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat st{};
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        m_size = static_cast<size_t>(st.st_size);
+        void* p = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            std::cerr << "Cannot map results file " << path << "\n";
+        } else {
+            m_data = static_cast<const unsigned char*>(p);
+            madvise(p, m_size, MADV_SEQUENTIAL);
+        }
+    }
+    ::close(fd);
+    if (!m_data) return;
+
+    size_t off = 0;
+    while (off + sizeof(BlockHeader) <= m_size) {
+        BlockHeader h;
+        std::memcpy(&h, m_data + off, sizeof(h));
+        if (h.magic != block_magic) break;
+        if (h.version > format_version) {
+            m_newer = true;
+            std::cerr << path << ": stopping at a block from a newer format (version " << h.version << ")\n";
+            break;
+        }
+        if (h.version != format_version || h.bytes != expected_bytes(h) || h.bytes > m_size - off) break;
+
+        const unsigned char* start = m_data + off;
+        const unsigned char* end = start + h.bytes - sizeof(uint64_t);
+        uint64_t sum;
+        std::memcpy(&sum, end, sizeof(sum));
+        if (sum != checksum(start, static_cast<size_t>(end - start))) break;
+
+        // Names stay out of m_names until the whole block checks out
+        const unsigned char* p = start + sizeof(h);
+        const unsigned char* namesEnd = p + h.namesBytes;
+        std::vector<std::string> names;
+        for (uint32_t i = 0; i < h.newNames; ++i) {
+            uint16_t len;
+            if (namesEnd - p < static_cast<std::ptrdiff_t>(sizeof(len))) break;
+            std::memcpy(&len, p, sizeof(len));
+            p += sizeof(len);
+            if (namesEnd - p < len) break;
+            names.emplace_back(reinterpret_cast<const char*>(p), len);
+            p += len;
+        }
+        if (names.size() != h.newNames) break;
+        p = namesEnd;
+
+        Block b;
+        b.matches = h.matches;
+        b.entries = h.entries;
+        take_column(p, b.matches, b.configHash);
+        take_column(p, b.matches, b.seed);
+        take_column(p, b.matches, b.rounds);
+        take_column(p, b.matches, b.winner);
+        take_column(p, b.matches, b.entryCount);
+        take_column(p, b.entries, b.robot);
+        take_column(p, b.entries, b.place);
+        take_column(p, b.entries, b.damageDealt);
+        take_column(p, b.entries, b.damageTaken);
+        take_column(p, b.entries, b.cpuUs);
+        take_column(p, b.entries, b.heapKb);
+
+        // Every id must name a robot, and the matches' robots must add up
+        // to the entries, before anything indexes by them
+        size_t known = m_names.size() + names.size();
+        uint64_t counted = 0;
+        bool sane = true;
+        for (size_t m = 0; m < b.matches && sane; ++m) {
+            counted += b.entryCount[m];
+            sane = b.winner[m] >= -1 && (b.winner[m] < 0 || static_cast<size_t>(b.winner[m]) < known);
+        }
+        for (size_t e = 0; e < b.entries && sane; ++e) sane = b.robot[e] < known;
+        if (!sane || counted != b.entries) break;
+
+        m_names.insert(m_names.end(), std::make_move_iterator(names.begin()), std::make_move_iterator(names.end()));
+        m_blocks.push_back(b);
+        m_matches += b.matches;
+        m_entries += b.entries;
+        off += h.bytes;
+    }
+    m_valid = off;
+    // a block cut short by a crash mid-append, or damaged since
+    if (off != m_size && !m_newer) std::cerr << path << ": ignoring " << m_size - off << " damaged bytes at the end\n";
+}
+
+Reader::~Reader() {
+    if (m_data) munmap(const_cast<unsigned char*>(m_data), m_size);
+}
+
+} // namespace results
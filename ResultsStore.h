@@ -0,0 +1,137 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+
+#include "Arena.h"
+
+// Append-only columnar file of match results.
+//
+// The file is a run of self-contained blocks, each written with one write()
+// so a crash can only leave a torn last block. Readers stop at the first
+// block that does not check out, and a writer cuts the file back to the last
+// whole block before appending. A block holds a batch of matches as columns:
+//
+//   header       BlockHeader
+//   names        robot names first used in this block (u16 length + bytes);
+//                ids are assigned in file order, so the dictionary is rebuilt
+//                by reading the blocks front to back
+//   per match    config_hash u64, seed u32, rounds u32, winner i32 (robot id
+//                or -1), entries u32 (number of robots)
+//   per robot    robot u32, place u32 (MatchResult::places), damage_dealt i32,
+//                damage_taken i32, cpu_us u32, heap_kb u32 (peak); a match's
+//                robots are consecutive, in match order
+//   checksum     u64 over everything before it
+//
+// Every section starts 8-byte aligned, so a reader maps the file and uses
+// the columns in place as plain arrays.
+namespace results {
+
+struct BlockHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t matches;
+    uint32_t entries;
+    uint32_t newNames;
+    uint32_t namesBytes; // padded to 8
+    uint64_t bytes;      // whole block including this header
+};
+
+constexpr uint32_t block_magic = 0x42435752; // "RWCB"
+constexpr uint32_t format_version = 1;
+
+// Buffers results and appends them a block at a time. Safe to share
+// between threads; the last partial block is written by flush() or on
+// destruction. One writer per file: robot ids come from the writer's own
+// dictionary, so the file is locked while it is open and a second writer
+// fails instead of appending clashing ids.
+class Writer {
+public:
+    explicit Writer(const std::string& path, size_t blockMatches = 4096);
+    ~Writer();
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    bool ok() const { return m_fd >= 0; }
+    void append(const MatchResult& r);
+    bool flush();
+    // flush(), then fdatasync: the blocks written so far survive the
+    // machine going down, not just the process
+    bool sync();
+    // Bytes in the file, not counting matches still buffered
+    uint64_t file_size();
+
+private:
+    std::string m_path;
+    int m_fd = -1;
+    size_t m_blockMatches;
+    std::mutex m_mutex;
+
+    std::unordered_map<std::string, uint32_t> m_ids;
+    std::vector<std::string> m_newNames;
+
+    std::vector<uint64_t> m_configHash;
+    std::vector<uint32_t> m_seed, m_rounds, m_entries;
+    std::vector<int32_t> m_winner;
+    std::vector<uint32_t> m_robot, m_place, m_cpuUs, m_heapKb;
+    std::vector<int32_t> m_dealt, m_taken;
+
+    uint32_t id_of(const std::string& name);
+    bool flush_locked();
+};
+
+// One block's columns, pointing into the mapped file
+struct Block {
+    size_t matches = 0;
+    size_t entries = 0;
+    const uint64_t* configHash = nullptr;
+    const uint32_t* seed = nullptr;
+    const uint32_t* rounds = nullptr;
+    const int32_t* winner = nullptr;
+    const uint32_t* entryCount = nullptr;
+    const uint32_t* robot = nullptr;
+    const uint32_t* place = nullptr;
+    const int32_t* damageDealt = nullptr;
+    const int32_t* damageTaken = nullptr;
+    const uint32_t* cpuUs = nullptr;
+    const uint32_t* heapKb = nullptr;
+};
+
+// Maps a results file read-only and exposes its blocks. Only blocks whose
+// sizes, checksum and robot ids all check out are exposed, so every robot id
+// and winner in them indexes names().
+class Reader {
+public:
+    explicit Reader(const std::string& path);
+    ~Reader();
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    bool ok() const { return m_data != nullptr || m_size == 0; }
+    const std::vector<Block>& blocks() const { return m_blocks; }
+    const std::vector<std::string>& names() const { return m_names; }
+    size_t matches() const { return m_matches; }
+    size_t entries() const { return m_entries; }
+    // Bytes of whole blocks at the front of the file, and the file's size
+    size_t valid_bytes() const { return m_valid; }
+    size_t file_bytes() const { return m_size; }
+    // Reading stopped at a block from a newer format, not at damage
+    bool newer_format() const { return m_newer; }
+
+private:
+    const unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_valid = 0;
+    bool m_newer = false;
+    std::vector<Block> m_blocks;
+    std::vector<std::string> m_names;
+    size_t m_matches = 0;
+    size_t m_entries = 0;
+};
+
+} // namespace results
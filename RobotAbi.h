@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "RobotBase.h"
+
+// Optional v2 robot entry point. A robot library may export, next to
+// create_robot,
+//
+//   extern "C" RobotAction robot_turn_v2(RobotBase* self, const RadarObj* radar, size_t count);
+//
+// and the arena then makes this one call per turn instead of the four
+// RobotBase virtuals. radar holds the scan for the direction the robot asked
+// for on its previous call, taken at the start of this turn (the 8 neighbors
+// on its first turn). The robot answers with its action and the direction to
+// scan before its next call. self is the instance create_robot built in the
+// same library, so the function can cast it back to its own class.
+// Libraries without the symbol keep the v1 calls.
+
+enum RobotActionKind : int32_t { robot_action_none = 0, robot_action_shoot = 1, robot_action_move = 2 };
+
+// 16 bytes, so it comes back in registers
+struct RobotAction {
+    int32_t radarDirection; // 0-8, scanned before the next call
+    int32_t kind;           // RobotActionKind
+    int32_t a;              // shot row, or move direction
+    int32_t b;              // shot column, or move distance
+};
+
+typedef RobotAction (*RobotTurnV2)(RobotBase* self, const RadarObj* radar, size_t count);
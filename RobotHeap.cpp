@@ -0,0 +1,229 @@
+#include "RobotHeap.h"
+#include <cstdlib>
+#include <algorithm>
+#include <new>
+
+namespace {
+
+// Every block handed out by operator new is preceded by this header so that
+// delete can tell heap memory from plain malloc memory on any thread.
+struct AllocHeader {
+    RobotHeap* heap;   // nullptr: plain malloc
+    std::size_t size;  // bytes requested by the caller
+};
+static_assert(sizeof(AllocHeader) == RobotHeap::granule);
+
+thread_local RobotHeap* current_heap = nullptr;
+
+// Chunks released by finished matches, kept per thread for the next one
+struct ChunkCache {
+    void* head = nullptr;
+    int count = 0;
+    static constexpr int max_cached = 256;
+
+    ~ChunkCache() {
+        while (head) {
+            void* next = *static_cast<void**>(head);
+            std::free(head);
+            head = next;
+        }
+    }
+};
+thread_local ChunkCache chunk_cache;
+
+std::atomic<std::size_t> retired_heaps{0};
+
+void* plain_allocate(std::size_t size) {
+    auto* h = static_cast<AllocHeader*>(std::malloc(sizeof(AllocHeader) + size));
+    if (!h) return nullptr;
+    h->heap = nullptr;
+    h->size = size;
+    return h + 1;
+}
+
+// Like the default operator new: a failed allocation runs the installed
+// new_handler and tries again, and only throws once there is none
+void* allocate_or_throw(std::size_t size) {
+    for (;;) {
+        void* p = current_heap ? current_heap->allocate(size) : plain_allocate(size);
+        if (p) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* allocate_or_null(std::size_t size) noexcept {
+    try {
+        return allocate_or_throw(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void deallocate_any(void* p) {
+    if (!p) return;
+    AllocHeader* h = static_cast<AllocHeader*>(p) - 1;
+    if (h->heap) h->heap->deallocate(p);
+    else std::free(h);
+}
+
+} // namespace
+
+RobotHeap::Scope::Scope(RobotHeap* heap) : previous(current_heap) { current_heap = heap; }
+RobotHeap::Scope::~Scope() { current_heap = previous; }
+
+RobotHeap::Ptr RobotHeap::make() {
+    // the heap's own bookkeeping is plain memory, never another robot's
+    Scope none(nullptr);
+    return Ptr(new RobotHeap);
+}
+
+RobotHeap::~RobotHeap() { free_all(); }
+
+std::size_t RobotHeap::retired_count() { return retired_heaps.load(std::memory_order_relaxed); }
+
+void* RobotHeap::carve(std::size_t blockBytes) {
+    if (cursor == nullptr || static_cast<std::size_t>(limit - cursor) < blockBytes) {
+        void* raw = chunk_cache.head;
+        if (raw) {
+            chunk_cache.head = *static_cast<void**>(raw);
+            --chunk_cache.count;
+        } else {
+            raw = std::malloc(chunk_size);
+            if (!raw) return nullptr;
+        }
+        Chunk* c = static_cast<Chunk*>(raw);
+        c->next = chunks;
+        chunks = c;
+        cursor = static_cast<char*>(raw) + sizeof(Chunk);
+        limit = static_cast<char*>(raw) + chunk_size;
+    }
+    void* p = cursor;
+    cursor += blockBytes;
+    return p;
+}
+
+void* RobotHeap::allocate(std::size_t size) {
+    if (max_bytes && size > max_bytes - std::min(current, max_bytes)) return nullptr;
+    current += size;
+    peak = std::max(peak, current);
+    ++live;
+
+    if (size <= max_small) {
+        std::size_t cls = size == 0 ? 0 : (size - 1) / granule;
+        AllocHeader* h;
+        if (FreeBlock* b = free_lists[cls]) {
+            free_lists[cls] = b->next;
+            h = reinterpret_cast<AllocHeader*>(b);
+        } else {
+            h = static_cast<AllocHeader*>(carve(sizeof(AllocHeader) + (cls + 1) * granule));
+            if (!h) { current -= size; --live; return nullptr; }
+        }
+        h->heap = this;
+        h->size = size;
+        return h + 1;
+    }
+
+    // Large blocks come straight from malloc but stay linked to the heap so
+    // release() can drop them with everything else
+    void* raw = std::malloc(sizeof(LargeBlock) + sizeof(AllocHeader) + size);
+    if (!raw) { current -= size; --live; return nullptr; }
+    LargeBlock* lb = static_cast<LargeBlock*>(raw);
+    lb->prev = nullptr;
+    lb->next = large;
+    if (large) large->prev = lb;
+    large = lb;
+    AllocHeader* h = reinterpret_cast<AllocHeader*>(lb + 1);
+    h->heap = this;
+    h->size = size;
+    return h + 1;
+}
+
+void RobotHeap::deallocate(void* p) {
+    AllocHeader* h = static_cast<AllocHeader*>(p) - 1;
+    if (retired) {
+        // the chunks go only once nothing in them is left
+        if (retired_live.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            retired_heaps.fetch_sub(1, std::memory_order_relaxed);
+            delete this;
+        }
+        return;
+    }
+    current -= h->size;
+    --live;
+    if (h->size <= max_small) {
+        std::size_t cls = h->size == 0 ? 0 : (h->size - 1) / granule;
+        FreeBlock* b = reinterpret_cast<FreeBlock*>(h);
+        b->next = free_lists[cls];
+        free_lists[cls] = b;
+        return;
+    }
+
+    LargeBlock* lb = reinterpret_cast<LargeBlock*>(h) - 1;
+    if (lb->prev) lb->prev->next = lb->next;
+    else large = lb->next;
+    if (lb->next) lb->next->prev = lb->prev;
+    std::free(lb);
+}
+
+bool RobotHeap::release() {
+    if (live) return false;
+    while (chunks) {
+        Chunk* next = chunks->next;
+        if (chunk_cache.count < ChunkCache::max_cached) {
+            *reinterpret_cast<void**>(chunks) = chunk_cache.head;
+            chunk_cache.head = chunks;
+            ++chunk_cache.count;
+        } else {
+            std::free(chunks);
+        }
+        chunks = next;
+    }
+    free_all();
+    return true;
+}
+
+// Returns whatever is left straight to malloc; a retired heap can die on a
+// thread whose chunk cache is already gone
+void RobotHeap::free_all() {
+    while (chunks) {
+        Chunk* next = chunks->next;
+        std::free(chunks);
+        chunks = next;
+    }
+    while (large) {
+        LargeBlock* next = large->next;
+        std::free(large);
+        large = next;
+    }
+    cursor = limit = nullptr;
+    current = 0;
+    live = 0;
+    for (auto& fl : free_lists) fl = nullptr;
+}
+
+void RobotHeap::retire() {
+    if (release()) {
+        delete this;
+        return;
+    }
+    retired_heaps.fetch_add(1, std::memory_order_relaxed);
+    retired_live.store(live, std::memory_order_release);
+    retired = true;
+}
+
+// Replacements for the global allocation functions. Robot libraries bind to
+// these too, because the executable's definitions interpose libstdc++'s.
+void* operator new(std::size_t size) { return allocate_or_throw(size); }
+void* operator new[](std::size_t size) { return allocate_or_throw(size); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate_or_null(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate_or_null(size); }
+
+void operator delete(void* p) noexcept { deallocate_any(p); }
+void operator delete[](void* p) noexcept { deallocate_any(p); }
+void operator delete(void* p, std::size_t) noexcept { deallocate_any(p); }
+void operator delete[](void* p, std::size_t) noexcept { deallocate_any(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { deallocate_any(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { deallocate_any(p); }
@@ -0,0 +1,96 @@
+#pragma once
+#include <cstddef>
+#include <atomic>
+#include <memory>
+
+// Memory for one robot instance during a match. While a RobotHeap::Scope is
+// active on a thread, the replaced global operator new (RobotHeap.cpp) serves
+// allocations from that heap instead of malloc. Small blocks are carved from
+// chunks and recycled through size-class free lists; release() hands every
+// chunk back to the calling thread's chunk cache at once, so the next match
+// reuses the same memory instead of going back to malloc.
+//
+// A robot can leave memory behind in its heap that outlives the instance: a
+// function-local static container, say, which the library's static
+// destructors only free at dlclose. Chunks are therefore only recycled once
+// every block in them has been freed. A heap dropped while blocks are still
+// live is retired instead: it stays, serving nothing but those frees, and
+// goes away with the last of them.
+//
+// The heap also keeps count of the bytes its robot holds, so the arena can
+// report them and, with set_limit(), cap them: an allocation that would go
+// over the limit fails, which operator new turns into std::bad_alloc.
+class RobotHeap {
+public:
+    // Owning pointer; dropping it retires the heap rather than deleting it
+    struct Retire { void operator()(RobotHeap* heap) const { heap->retire(); } };
+    using Ptr = std::unique_ptr<RobotHeap, Retire>;
+    static Ptr make();
+
+    RobotHeap(const RobotHeap&) = delete;
+    RobotHeap& operator=(const RobotHeap&) = delete;
+
+    void* allocate(std::size_t size);
+    void deallocate(void* p);
+
+    // Drop everything allocated from this heap once the robot instance is
+    // destroyed. False, with nothing dropped, if some block is still live;
+    // the heap then keeps serving from what it has.
+    bool release();
+
+    // Bytes requested and not yet freed, and the most that ever were. The
+    // peak survives release(), so it covers a whole match even when the
+    // arena rebuilds the robot from a snapshot.
+    std::size_t current_bytes() const { return current; }
+    std::size_t peak_bytes() const { return peak; }
+
+    // Most bytes the robot may hold at once; 0 = no limit
+    void set_limit(std::size_t bytes) { max_bytes = bytes; }
+    std::size_t byte_limit() const { return max_bytes; }
+
+    // Heaps dropped with live blocks that are still waiting for them
+    static std::size_t retired_count();
+
+    // Routes this thread's allocations into heap until the scope ends
+    class Scope {
+    public:
+        explicit Scope(RobotHeap* heap);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        RobotHeap* previous;
+    };
+
+    static constexpr std::size_t chunk_size = 64 * 1024;
+    static constexpr std::size_t granule = 16;
+    static constexpr std::size_t max_small = 1024;
+
+private:
+    RobotHeap() = default;
+    ~RobotHeap();
+
+    struct FreeBlock { FreeBlock* next; };
+    struct Chunk { Chunk* next; std::size_t pad; };
+    struct LargeBlock { LargeBlock* prev; LargeBlock* next; };
+
+    Chunk* chunks = nullptr;
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    FreeBlock* free_lists[max_small / granule] = {};
+    LargeBlock* large = nullptr;
+
+    std::size_t current = 0;
+    std::size_t peak = 0;
+    std::size_t max_bytes = 0;
+    std::size_t live = 0;   // blocks handed out and not yet freed
+
+    // Set once the owner has dropped the heap; frees can then come from any
+    // thread (a library's static destructors), so they only count down
+    bool retired = false;
+    std::atomic<std::size_t> retired_live{0};
+
+    void* carve(std::size_t blockBytes);
+    void retire();
+    void free_all();
+};
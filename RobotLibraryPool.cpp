@@ -0,0 +1,361 @@
+#include "RobotLibraryPool.h"
+#include <iostream>
+#include <filesystem>
+#include <memory>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <utility>
+#include <dlfcn.h>
+#include <link.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "StaticStateScan.h"
+
+// Optimization flags for robot libraries; the Makefile passes the ones for
+// its OPT_PROFILE
+#ifndef ROBOTWARZ_ROBOT_FLAGS
+#define ROBOTWARZ_ROBOT_FLAGS "-O2"
+#endif
+
+namespace {
+
+// ROBOTWARZ_ROBOT_FLAGS from the environment, else the build's
+std::string robot_flags() {
+    const char* env = std::getenv("ROBOTWARZ_ROBOT_FLAGS");
+    return env ? env : ROBOTWARZ_ROBOT_FLAGS;
+}
+
+std::string read_file(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+// The compiler's full version, asked once; an upgrade rebuilds every robot
+const std::string& compiler_version() {
+    static const std::string version = [] {
+        std::string out;
+        if (FILE* p = popen("g++ -dumpfullversion 2>/dev/null", "r")) {
+            char buf[64];
+            while (std::fgets(buf, sizeof(buf), p)) out += buf;
+            pclose(p);
+        }
+        return out;
+    }();
+    return version;
+}
+
+// The files a make-style dependency file (g++ -MMD -MF) lists after its
+// target: continuation lines are joined and "\ " is a space in a name
+std::vector<std::string> dependency_files(const std::filesystem::path& depFile) {
+    std::string text = read_file(depFile);
+    std::vector<std::string> out;
+    size_t colon = text.find(": ");
+    if (colon == std::string::npos) return out;
+
+    std::string name;
+    auto take = [&] {
+        if (!name.empty()) out.push_back(name);
+        name.clear();
+    };
+    for (size_t i = colon + 1; i < text.size(); ++i) {
+        char ch = text[i];
+        bool escape = ch == '\\' && i + 1 < text.size();
+        if (escape && text[i + 1] == ' ') {
+            name += ' ';
+            ++i;
+        } else if (escape && text[i + 1] == '\n') {
+            take();
+            ++i;
+        } else if (ch == ' ' || ch == '\t' || ch == '\n') {
+            take();
+        } else {
+            name += ch;
+        }
+    }
+    take();
+    return out;
+}
+
+// Everything a robot library was built from: the compile command, the
+// compiler version, every file the compiler read for it (the source and
+// each header, however it was included, as its dependency file lists them)
+// and the helper objects it links. Any change means a recompile. Empty when
+// there is no dependency file to go by.
+std::string build_inputs_hash(const std::string& cmd, const std::filesystem::path& depFile) {
+    std::vector<std::string> deps = dependency_files(depFile);
+    if (deps.empty()) return {};
+
+    uint64_t h = 1469598103934665603ULL;
+    auto mix = [&](const std::string& bytes) {
+        for (unsigned char b : bytes) {
+            h ^= b;
+            h *= 1099511628211ULL;
+        }
+        h ^= bytes.size();
+        h *= 1099511628211ULL;
+    };
+    mix(cmd);
+    mix(compiler_version());
+    for (const auto& dep : deps) {
+        mix(dep);
+        mix(read_file(dep));
+    }
+    for (const char* obj : {"RobotBase.o", "OccupancyMap.o", "PathPlanner.o"}) mix(read_file(obj));
+    return std::to_string(h);
+}
+
+// The writable PT_LOAD segments of an opened library: its .data and .bss
+// (and the GOT, which RTLD_NOW has already filled in)
+std::vector<std::pair<unsigned char*, size_t>> writable_segments(void* handle) {
+    std::vector<std::pair<unsigned char*, size_t>> out;
+    struct link_map* lm = nullptr;
+    if (dlinfo(handle, RTLD_DI_LINKMAP, &lm) != 0 || !lm) return out;
+
+    struct Search {
+        ElfW(Addr) base;
+        std::vector<std::pair<unsigned char*, size_t>>* out;
+    } search{lm->l_addr, &out};
+    dl_iterate_phdr([](struct dl_phdr_info* info, size_t, void* data) -> int {
+        auto* s = static_cast<Search*>(data);
+        if (info->dlpi_addr != s->base) return 0;
+        for (int i = 0; i < info->dlpi_phnum; ++i) {
+            const ElfW(Phdr)& ph = info->dlpi_phdr[i];
+            if (ph.p_type != PT_LOAD || !(ph.p_flags & PF_W)) continue;
+            s->out->emplace_back(reinterpret_cast<unsigned char*>(info->dlpi_addr + ph.p_vaddr), ph.p_memsz);
+        }
+        return 1;
+    }, &search);
+    return out;
+}
+
+} // namespace
+
+// A pinned library opened from an in-memory file of its own, so it gets
+// .data/.bss no other copy shares. pristine holds its writable segments as
+// they were right after opening; a copy whose segments still match them
+// can go to the next arena as it is.
+struct RobotLibraryPool::PrivateCopy {
+    std::string library;                // the shared library this copies
+    RobotFactory original = nullptr;    // its factory, in case the library is rebuilt
+    std::string image;                  // the library's bytes
+    int fd = -1;
+    void* handle = nullptr;
+    RobotFactory factory = nullptr;
+    RobotTurnV2 turn = nullptr;
+    bool leased = false;
+    std::vector<std::pair<unsigned char*, size_t>> writable;
+    std::vector<unsigned char> pristine;
+
+    bool used() const {
+        size_t at = 0;
+        for (const auto& [p, n] : writable) {
+            if (std::memcmp(p, pristine.data() + at, n) != 0) return true;
+            at += n;
+        }
+        return false;
+    }
+
+    void close() {
+        if (handle) dlclose(handle);
+        if (fd >= 0) ::close(fd);
+        handle = nullptr;
+        fd = -1;
+    }
+};
+
+RobotLibraryPool::RobotLibraryPool() = default;
+
+RobotLibraryPool::~RobotLibraryPool() {
+    for (auto& c : copies) c->close();
+    for (void* h : handles) {
+        if (h) dlclose(h);
+    }
+}
+
+RobotLibraryPool& RobotLibraryPool::shared() {
+    static RobotLibraryPool pool;
+    return pool;
+}
+
+bool RobotLibraryPool::load_directory(const std::string& directory) {
+    bool anyLoaded = false;
+    for (auto& p : std::filesystem::directory_iterator(directory)) {
+        if (!p.is_regular_file()) continue;
+        auto name = p.path().filename().string();
+        if (name.rfind("Robot_", 0) != 0 || p.path().extension() != ".cpp") continue;
+
+        if (load_source(p.path().string())) anyLoaded = true;
+    }
+    return anyLoaded;
+}
+
+bool RobotLibraryPool::load_source(const std::string& cppPath) {
+    std::filesystem::path path(cppPath);
+    std::string name = path.filename().string();
+    std::string stem = path.stem().string();
+
+    std::string so = "./lib" + stem + ".so";
+    // -fno-gnu-unique keeps function-local statics out of the process-wide
+    // unique symbol table, so private copies of a library really are private
+    // -MMD -MF <so>.d has the compiler list every file it read
+    std::string deps = so + ".d";
+    std::string cmd = "g++ -shared -fPIC -fno-gnu-unique " + robot_flags() + " -MMD -MF " + deps + " -o " + so + " " +
+                      path.string() + " RobotBase.o OccupancyMap.o PathPlanner.o -I. -std=c++20";
+
+    // <so>.stamp holds the hash of what the library was last built from, so
+    // an unchanged robot is not recompiled on every start (or resume)
+    std::string stamp = so + ".stamp";
+    std::string inputs = build_inputs_hash(cmd, deps);
+    if (!inputs.empty() && std::filesystem::exists(so) && read_file(stamp) == inputs) {
+        std::cout << "Up to date " << name << " -> " << so << "\n";
+    } else {
+        std::cout << "Compiling " << name << " -> " << so << "\n";
+        std::filesystem::remove(stamp);
+        if (std::system(cmd.c_str()) != 0) {
+            std::cerr << "Compile failed: " << name << "\n";
+            return false;
+        }
+        std::ofstream(stamp, std::ios::binary) << build_inputs_hash(cmd, deps);
+    }
+
+    if (stem.rfind("Robot_", 0) == 0) stem = stem.substr(6); // strip "Robot_"
+    return open_library(so, stem);
+}
+
+void* RobotLibraryPool::open_checked(const std::string& soPath, RobotFactory& create_robot, RobotTurnV2& turn, bool probe) {
+    // RTLD_NOW: resolve everything here rather than inside the first robot calls
+    void* handle = dlopen(soPath.c_str(), RTLD_NOW);
+    if (!handle) { std::cerr << "dlopen failed: " << soPath << " : " << dlerror() << "\n"; return nullptr; }
+
+    create_robot = (RobotFactory)dlsym(handle, "create_robot");
+    if (!create_robot) {
+        std::cerr << "dlsym failed: create_robot in " << soPath << " : " << dlerror() << "\n";
+        dlclose(handle);
+        return nullptr;
+    }
+    // optional; a v1 library simply doesn't have it
+    turn = (RobotTurnV2)dlsym(handle, "robot_turn_v2");
+    dlerror();
+
+    // Build and drop one instance so a broken factory is caught at load time
+    if (!probe) return handle;
+    std::unique_ptr<RobotBase> instance(create_robot());
+    if (!instance) {
+        std::cerr << "create_robot returned null for " << soPath << "\n";
+        dlclose(handle);
+        return nullptr;
+    }
+    return handle;
+}
+
+bool RobotLibraryPool::open_library(const std::string& soPath, const std::string& name) {
+    RobotFactory create_robot = nullptr;
+    RobotTurnV2 turn = nullptr;
+    void* handle = open_checked(soPath, create_robot, turn);
+    if (!handle) return false;
+
+    RobotFactoryEntry entry{name, create_robot, soPath, false, turn};
+
+    std::vector<std::string> statics;
+    if (find_writable_statics(soPath, statics) && !statics.empty()) {
+        entry.pinned = true;
+        std::cout << "Robot " << name << " has shared static state; each arena gets a private copy of "
+                  << soPath << ":\n";
+        for (const auto& sym : statics) std::cout << "  " << sym << "\n";
+    }
+
+    handles.push_back(handle);
+    roster.push_back(entry);
+    return true;
+}
+
+RobotLibraryPool::Lease RobotLibraryPool::lease_private_copy(const RobotFactoryEntry& shared, RobotFactoryEntry& copy) {
+    Lease lease;
+    PrivateCopy* c = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(copies_mutex);
+        for (size_t i = 0; i < copies.size() && !c; ++i) {
+            PrivateCopy& candidate = *copies[i];
+            if (candidate.leased || candidate.library != shared.library || candidate.original != shared.factory) continue;
+            c = &candidate;
+            lease.m_copy = i;
+        }
+        if (!c) {
+            copies.push_back(std::make_unique<PrivateCopy>());
+            c = copies.back().get();
+            c->library = shared.library;
+            c->original = shared.factory;
+            lease.m_copy = copies.size() - 1;
+        }
+        c->leased = true;
+    }
+
+    // The copy is this lease's alone now; (re)opening it needs no lock
+    if (c->handle && c->used()) c->close();
+    if (!c->handle && !open_copy(*c, shared.name)) {
+        give_back(lease.m_copy);
+        return Lease{};
+    }
+    lease.m_pool = this;
+    copy = RobotFactoryEntry{shared.name, c->factory, shared.library, true, c->turn};
+    return lease;
+}
+
+bool RobotLibraryPool::open_copy(PrivateCopy& c, const std::string& name) {
+    if (c.image.empty()) c.image = read_file(c.library);
+    if (c.image.empty()) { std::cerr << "Cannot read " << c.library << " for " << name << "\n"; return false; }
+
+    // A library opened from a different file gets its own .data/.bss. An
+    // in-memory file leaves nothing on disk, even for a worker that exits
+    // without cleaning up.
+    c.fd = memfd_create(("robotwarz-" + name).c_str(), MFD_CLOEXEC);
+    if (c.fd < 0) { std::cerr << "Cannot create a private copy of " << c.library << " for " << name << "\n"; return false; }
+    for (size_t at = 0; at < c.image.size();) {
+        ssize_t n = ::write(c.fd, c.image.data() + at, c.image.size() - at);
+        if (n <= 0) {
+            std::cerr << "Cannot write a private copy of " << c.library << " for " << name << "\n";
+            c.close();
+            return false;
+        }
+        at += static_cast<size_t>(n);
+    }
+
+    // The shared library was probed when it was loaded, and a probe here
+    // would leave the copy used before its first lease
+    c.handle = open_checked("/proc/self/fd/" + std::to_string(c.fd), c.factory, c.turn, false);
+    if (!c.handle) {
+        c.close();
+        return false;
+    }
+
+    c.writable = writable_segments(c.handle);
+    c.pristine.clear();
+    for (const auto& [p, n] : c.writable) c.pristine.insert(c.pristine.end(), p, p + n);
+    return true;
+}
+
+void RobotLibraryPool::give_back(size_t copy) {
+    std::lock_guard<std::mutex> lock(copies_mutex);
+    copies[copy]->leased = false;
+}
+
+RobotLibraryPool::Lease::Lease(Lease&& other) noexcept
+    : m_pool(std::exchange(other.m_pool, nullptr)), m_copy(other.m_copy) {}
+
+RobotLibraryPool::Lease& RobotLibraryPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        if (m_pool) m_pool->give_back(m_copy);
+        m_pool = std::exchange(other.m_pool, nullptr);
+        m_copy = other.m_copy;
+    }
+    return *this;
+}
+
+RobotLibraryPool::Lease::~Lease() {
+    if (m_pool) m_pool->give_back(m_copy);
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+#include "RobotRegistry.h"
+
+// Owns compiled robot libraries for as long as it lives. Each library is
+// opened once with RTLD_NOW so every symbol is bound before the first turn,
+// and create_robot is checked up front. The optional robot_turn_v2 entry
+// point is looked up at the same time. Any number of arenas can build their
+// robots from factories(); none of them dlopen anything themselves.
+class RobotLibraryPool {
+public:
+    RobotLibraryPool();
+    ~RobotLibraryPool();
+
+    RobotLibraryPool(const RobotLibraryPool&) = delete;
+    RobotLibraryPool& operator=(const RobotLibraryPool&) = delete;
+
+    // Compile every Robot_*.cpp in directory into lib<stem>.so and open it
+    bool load_directory(const std::string& directory);
+
+    // Compile a single robot source and open it
+    bool load_source(const std::string& cppPath);
+
+    // Open an already compiled library under the given arena-side name.
+    // Libraries with writable static data are reported and marked pinned.
+    bool open_library(const std::string& soPath, const std::string& name);
+
+    // A private copy of a pinned robot's library, held by one arena at a
+    // time and handed back to the pool when the lease goes away
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        ~Lease();
+
+        explicit operator bool() const { return m_pool != nullptr; }
+
+    private:
+        friend class RobotLibraryPool;
+        RobotLibraryPool* m_pool = nullptr;
+        size_t m_copy = 0;
+    };
+
+    // Lease a private copy of a pinned robot's library, so the instances
+    // built from copy's factory have static data no other arena can touch.
+    // Copies are kept and reused; one whose statics a previous arena changed
+    // is reopened first, so every lease starts from the library's initial
+    // state. Thread-safe.
+    Lease lease_private_copy(const RobotFactoryEntry& shared, RobotFactoryEntry& copy);
+
+    const std::vector<RobotFactoryEntry>& factories() const { return roster; }
+
+    // Process-wide pool; its libraries stay open until the program exits
+    static RobotLibraryPool& shared();
+
+private:
+    std::vector<RobotFactoryEntry> roster;
+    std::vector<void*> handles;
+
+    struct PrivateCopy;
+    std::mutex copies_mutex;
+    std::vector<std::unique_ptr<PrivateCopy>> copies;
+
+    void* open_checked(const std::string& soPath, RobotFactory& create_robot, RobotTurnV2& turn, bool probe = true);
+    bool open_copy(PrivateCopy& c, const std::string& name);
+    void give_back(size_t copy);
+};
@@ -2,15 +2,32 @@
 #include <vector>
 #include <memory>
 #include <string>
-#include "RobotBase.h"
+#include "RobotAbi.h"
+#include "RobotHeap.h"
 
 struct RobotEntry {
+    // the robot's allocations live here; declared first so it outlives instance
+    RobotHeap::Ptr heap;
     std::unique_ptr<RobotBase> instance;
+    RobotFactory factory = nullptr; // create_robot from the robot's library, used to rebuild on restore
+    RobotTurnV2 turn = nullptr;     // the library's robot_turn_v2, if it has one
+    int nextRadarDir = 0;           // v2: the scan it asked for on its last call
     std::string name; // from print_stats or set later
     char glyph = '?'; // character to display, e.g., '@', '$'
     int row = -1;
     int col = -1;
     bool alive = true;
+    bool sharedStatics = false; // library has writable statics shared by every copy in this arena
+
+    int damageDealt = 0;      // damage this robot's shots did to others
+    int damageTaken = 0;      // damage it took from shots and flamethrowers
+    int shotsFired = 0;       // counted against the weapon's ammo
+
+    // CPU accounting, kept while the arena has budgets or timeRobots set
+    long long cpuNs = 0;      // CPU time spent in robot calls this match
+    int budgetBreaches = 0;   // calls that went over a budget
+    int forfeitedTurns = 0;   // turns whose action was thrown away for it
+    int memoryBreaches = 0;   // calls that ran out of GameConfig::memoryBudgetKb
 
     // Arena-side metadata (since RobotBase cannot be changed)
     std::string lastRadarLog;
@@ -23,9 +40,12 @@ class RobotList {
 public:
 
     // Add a robot (takes ownership)
-    int add(std::unique_ptr<RobotBase> rb, char glyph, const std::string& robotName) {
+    int add(std::unique_ptr<RobotBase> rb, char glyph, const std::string& robotName, RobotFactory factory = nullptr,
+            RobotHeap::Ptr heap = nullptr) {
     RobotEntry e;
+    e.heap = std::move(heap);
     e.instance = std::move(rb);
+    e.factory = factory;
     e.glyph = glyph;
     e.name = robotName;   // store Arena-side name
     e.alive = true;
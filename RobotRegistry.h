@@ -0,0 +1,23 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "RobotAbi.h"
+
+// A robot the arena can instantiate without compiling anything: the name
+// shown in the arena (file stem without "Robot_") and its create_robot.
+struct RobotFactoryEntry {
+    std::string name;
+    RobotFactory factory = nullptr;
+
+    // Set by RobotLibraryPool: the library the factory lives in, and whether
+    // that library has writable statics shared by all of its instances.
+    std::string library;
+    bool pinned = false;
+
+    // robot_turn_v2 if the library exports it, else nullptr (v1 calls only)
+    RobotTurnV2 turn = nullptr;
+};
+
+// Roster linked into the robotwarz_static binary. The definition lives in
+// StaticRobots.gen.cpp, which the Makefile generates from the Robot_*.cpp files.
+const std::vector<RobotFactoryEntry>& static_robot_registry();
@@ -1,8 +1,51 @@
 #include <iostream>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <cstdio>
 #include "Arena.h"
 
 int main(int argc, char** argv) {
-    // Optional CLI: arena size and robots directory
+    // Optional CLI: robots directory, arena size and copies of each robot,
+    // plus --simultaneous for the simultaneous-turn rules and
+    // --call-budget-us=N / --match-budget-us=N for robot CPU budgets,
+    // --memory-budget-kb=N for the heap each robot may hold and
+    // --stalemate=K to end a match after K quiet rounds with no way forward.
+    // --decision-threads=N sets the simultaneous-mode thread count and
+    // --hash-trace prints the state hash after every round, so two runs
+    // (e.g. 1 and N decision threads) can be diffed. --map=file.rwm plays on
+    // a fixed layout (see map_convert) instead of random obstacles, and
+    // --rules=spec|legacy picks the weapon and obstacle numbers (Rules.h)
+    std::string mapPath;
+    const Rules* rules = &spec_rules;
+    bool simultaneous = false, hashTrace = false;
+    unsigned decisionThreads = 0;
+    long long callBudgetUs = 0, matchBudgetUs = 0, memoryBudgetKb = 0;
+    int stalemateRounds = 0;
+    std::vector<char*> args;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--simultaneous") simultaneous = true;
+        else if (arg.rfind("--call-budget-us=", 0) == 0) callBudgetUs = std::atoll(arg.c_str() + 17);
+        else if (arg.rfind("--match-budget-us=", 0) == 0) matchBudgetUs = std::atoll(arg.c_str() + 18);
+        else if (arg.rfind("--memory-budget-kb=", 0) == 0) memoryBudgetKb = std::atoll(arg.c_str() + 19);
+        else if (arg.rfind("--stalemate=", 0) == 0) stalemateRounds = std::atoi(arg.c_str() + 12);
+        else if (arg.rfind("--decision-threads=", 0) == 0) decisionThreads = static_cast<unsigned>(std::atoi(arg.c_str() + 19));
+        else if (arg == "--hash-trace") hashTrace = true;
+        else if (arg.rfind("--map=", 0) == 0) mapPath = arg.substr(6);
+        else if (arg.rfind("--rules=", 0) == 0) {
+            rules = find_rules(arg.substr(8));
+            if (!rules) {
+                std::cerr << "Unknown rules " << arg.substr(8) << "\n";
+                return 1;
+            }
+        }
+        else args.push_back(argv[i]);
+    }
+    argc = static_cast<int>(args.size());
+    argv = args.data();
+
     std::string robotsDir = ".";
     if (argc >= 2) robotsDir = argv[1];
 
@@ -16,13 +59,58 @@ int main(int argc, char** argv) {
     cfg.liveView = true;
     cfg.rngSeed = 1234;
 
+    // Large arenas: obstacles keep the default density, the display follows
+    // the first robot through a 20x20 window and turns are not animated
+    if (argc >= 3) {
+        int size = std::max(10, std::atoi(argv[2]));
+        double scale = static_cast<double>(size) * size / (cfg.width * cfg.height);
+        cfg.width = cfg.height = size;
+        cfg.mounds = static_cast<int>(cfg.mounds * scale);
+        cfg.pits = static_cast<int>(cfg.pits * scale);
+        cfg.flamers = static_cast<int>(cfg.flamers * scale);
+        if (size > 20) {
+            cfg.viewRows = cfg.viewCols = 20;
+            cfg.liveView = false;
+        }
+    }
+    if (argc >= 4) cfg.robotCopies = std::max(1, std::atoi(argv[3]));
+    cfg.simultaneousTurns = simultaneous;
+    cfg.callBudgetUs = callBudgetUs;
+    cfg.matchBudgetUs = matchBudgetUs;
+    cfg.memoryBudgetKb = memoryBudgetKb;
+    cfg.stalemateRounds = stalemateRounds;
+    cfg.decisionThreads = decisionThreads;
+    cfg.mapPath = mapPath;
+    cfg.rules = *rules;
+    if (!mapPath.empty()) {
+        auto map = GameMap::shared(mapPath);
+        if (!map) return 1;
+        if (map->rows() > 20 || map->cols() > 20) {
+            cfg.viewRows = cfg.viewCols = 20;
+            cfg.liveView = false;
+        }
+    }
+
     Arena arena(cfg);
 
+#ifdef ROBOTWARZ_STATIC_ROBOTS
+    // Production build: roster compiled into this binary
+    if (!arena.load_robots(static_robot_registry())) {
+        std::cerr << "No robots compiled into this build\n";
+        return 1;
+    }
+#else
     if (!arena.load_robots_from_sources(robotsDir)) {
         std::cerr << "No robots loaded from: " << robotsDir << "\n";
         return 1;
     }
+#endif
 
-    arena.run();
+    MatchResult result = arena.run();
+    if (hashTrace) {
+        const auto& trace = arena.hash_trace();
+        for (size_t i = 0; i < trace.size(); ++i) std::printf("round %zu %016llx\n", i + 1, static_cast<unsigned long long>(trace[i]));
+        std::printf("final %016llx\n", static_cast<unsigned long long>(result.stateHash));
+    }
     return 0;
 }
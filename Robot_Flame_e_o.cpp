@@ -1,7 +1,8 @@
 #include "RobotBase.h"
+#include "OccupancyMap.h"
+#include "PathPlanner.h"
 #include <cstdlib>
 #include <ctime>
-#include <set>
 #include <cmath>
 #include <limits>
 #include <utility>
@@ -16,7 +17,12 @@ private:
     int radar_direction = 1; // Radar scanning direction (1-8)
     bool fixed_radar = false; // Tracks whether radar is locked on a target
     const int max_range = 4; // Maximum range of the flamethrower
-    std::set<std::pair<int, int>> obstacles_memory; // Memory of obstacles
+    OccupancyMap obstacles_memory; // Memory of obstacles
+    PathPlanner planner{obstacles_memory, 4, 4000}; // Shortest paths around remembered obstacles, within the per-call budget
+
+    bool chase_known = false; // Last enemy seen out of range, worth walking to
+    int chase_row = -1;
+    int chase_col = -1;
 
     // Helper function to calculate Manhattan distance
     int calculate_distance(int row1, int col1, int row2, int col2) const 
@@ -29,12 +35,20 @@ private:
     {
         target_found = false;
         int closest_distance = std::numeric_limits<int>::max();
+        int closest_any = std::numeric_limits<int>::max();
 
         for (const auto& obj : radar_results) 
         {
             if (obj.m_type == 'R') // Enemy robot
             {
                 int distance = calculate_distance(current_row, current_col, obj.m_row, obj.m_col);
+                if (distance < closest_any) 
+                {
+                    closest_any = distance;
+                    chase_row = obj.m_row;
+                    chase_col = obj.m_col;
+                    chase_known = true;
+                }
                 if (distance <= max_range && distance < closest_distance) 
                 {
                     closest_distance = distance;
@@ -50,19 +64,8 @@ private:
     // Update the memory of obstacles
     void update_obstacle_memory(const std::vector<RadarObj>& radar_results) 
     {
-        for (const auto& obj : radar_results) 
-        {
-            if (obj.m_type == 'M' || obj.m_type == 'P' || obj.m_type == 'F') 
-            {
-                obstacles_memory.insert({obj.m_row, obj.m_col});
-            }
-        }
-    }
-
-    // Check if a cell is passable
-    bool is_passable(int row, int col) const 
-    {
-        return obstacles_memory.find({row, col}) == obstacles_memory.end();
+        obstacles_memory.ensure_size(m_board_row_max, m_board_col_max);
+        obstacles_memory.update(radar_results);
     }
 
 public:
@@ -141,31 +144,36 @@ public:
         int current_row, current_col;
         get_current_location(current_row, current_col);
 
-        if (target_found) 
+        if (target_found || chase_known) 
         {
-            // Move toward the target while avoiding obstacles
-            int row_step = (target_row > current_row) ? 1 : (target_row < current_row) ? -1 : 0;
-            int col_step = (target_col > current_col) ? 1 : (target_col < current_col) ? -1 : 0;
-
-            // Prioritize row movement, then column movement
-            if (is_passable(current_row + row_step, current_col)) 
-            {
-                move_direction = (row_step > 0) ? 5 : 1; // Down or Up
-                move_distance = 1;
-            } 
-            else if (is_passable(current_row, current_col + col_step)) 
+            // Walk the shortest known path toward the target instead of stepping greedily into mounds
+            int goal_row = target_found ? target_row : chase_row;
+            int goal_col = target_found ? target_col : chase_col;
+            PathPlanner::Step step = planner.toward(current_row, current_col, goal_row, goal_col, get_move_speed());
+            if (step.direction != 0) 
             {
-                move_direction = (col_step > 0) ? 3 : 7; // Right or Left
-                move_distance = 1;
-            } 
-            else 
+                move_direction = step.direction;
+                move_distance = step.distance;
+                return;
+            }
+            if (step.pending) 
             {
-                // Stay in place if movement is blocked
-                move_direction = 0;
-                move_distance = 0;
+                // Path still being searched: head straight for it this turn
+                int dr = (goal_row > current_row) - (goal_row < current_row);
+                int dc = (goal_col > current_col) - (goal_col < current_col);
+                for (int d = 1; d <= 8; ++d) 
+                {
+                    if (directions[d].first == dr && directions[d].second == dc) 
+                    {
+                        move_direction = d;
+                        move_distance = 1;
+                        return;
+                    }
+                }
             }
 
-            return;
+            // Reached or unreachable: go back to wandering
+            chase_known = false;
         }
 
         // Random movement if no target is found
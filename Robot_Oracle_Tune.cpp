@@ -48,8 +48,8 @@ public:
         for (const auto& obj : results) {
             if (obj.m_type != 'R') continue;
 
-            // Use row/col as pseudo‑unique key
-            int key = obj.m_row * 100 + obj.m_col;
+            // Use the flat cell index as key; unique for any board width
+            int key = obj.m_row * m_board_col_max + obj.m_col;
             auto& tr = tracks[key];
 
             tr.prev_row = tr.row;
@@ -93,8 +93,8 @@ public:
 
             if (score > best_score) {
                 best_score = score;
-                predicted_row = std::clamp(prow, 0, 19);
-                predicted_col = std::clamp(pcol, 0, 19);
+                predicted_row = std::clamp(prow, 0, m_board_row_max - 1);
+                predicted_col = std::clamp(pcol, 0, m_board_col_max - 1);
                 has_target = true;
             }
         }
@@ -1,7 +1,8 @@
 #include "RobotBase.h"
+#include "OccupancyMap.h"
 #include <vector>
 #include <iostream>
-#include <algorithm> // For std::find_if
+#include <algorithm>
 
 class Robot_Ratboy : public RobotBase 
 {
@@ -10,16 +11,7 @@ private:
     int to_shoot_row = -1;   // Tracks the row of the next target to shoot
     int to_shoot_col = -1;   // Tracks the column of the next target to shoot
     
-    std::vector<RadarObj> known_obstacles; // Permanent obstacle list
-
-    // Helper function to determine if a cell is an obstacle
-    bool is_obstacle(int row, int col) const 
-    {
-        return std::any_of(known_obstacles.begin(), known_obstacles.end(), 
-                           [&](const RadarObj& obj) {
-                               return obj.m_row == row && obj.m_col == col;
-                           });
-    }
+    OccupancyMap known_obstacles; // Permanent obstacle memory, one bit per cell
 
     // Clears the target when no enemy is found
     void clear_target() 
@@ -28,16 +20,6 @@ private:
         to_shoot_col = -1;
     }
 
-    // Helper function to add an obstacle to the list if it's not already there
-    void add_obstacle(const RadarObj& obj) 
-    {
-        if (obj.m_type == 'M' || obj.m_type == 'P' || obj.m_type == 'F' && 
-            !is_obstacle(obj.m_row, obj.m_col)) 
-        {
-            known_obstacles.push_back(obj);
-        }
-    }
-
 public:
     Robot_Ratboy() : RobotBase(3, 4, railgun) {
         m_name = "Ratboy";
@@ -59,11 +41,12 @@ public:
     {
         clear_target();
 
+        // Remember static obstacles
+        known_obstacles.ensure_size(m_board_row_max, m_board_col_max);
+        known_obstacles.update(radar_results);
+
         for (const auto& obj : radar_results) 
         {
-            // Add static obstacles to the obstacle list
-            add_obstacle(obj);
-
             // Identify the first enemy found as the target
             if (obj.m_type == 'R' && to_shoot_row == -1 && to_shoot_col == -1) 
             {
@@ -1,8 +1,10 @@
 #include "RobotBase.h"
+#include "RobotAbi.h"
 #include <vector>
 #include <string>
+#include <span>
 
-class Robot_TuNe : public RobotBase {
+class Robot_TuNe final : public RobotBase {
 public:
     Robot_TuNe() : RobotBase(2, 3, WeaponType::grenade) {
         m_name = "TuNe";
@@ -16,6 +18,10 @@ public:
     }
 
     void process_radar_results(const std::vector<RadarObj>& results) override {
+        look(results);
+    }
+
+    void look(std::span<const RadarObj> results) {
         has_adjacent_target = false;
         for (const auto& obj : results) {
             if (obj.m_type == 'R') {
@@ -49,7 +55,18 @@ public:
             return;
         }
     }
-   
+
+    // The whole turn in one call for the arena's v2 entry point; it always
+    // scans its neighbors, so getting last turn's scan changes nothing
+    RobotAction turn(std::span<const RadarObj> radar) {
+        look(radar);
+        int row = 0, col = 0;
+        if (get_shot_location(row, col)) return {0, robot_action_shoot, row, col};
+        int dir = 0, dist = 0;
+        get_move_direction(dir, dist);
+        return {0, robot_action_move, dir, dist};
+    }
+
 
 private:
     int grenades_left;
@@ -64,3 +81,7 @@ private:
 extern "C" RobotBase* create_robot() {
     return new Robot_TuNe();
 }
+
+extern "C" RobotAction robot_turn_v2(RobotBase* self, const RadarObj* radar, size_t count) {
+    return static_cast<Robot_TuNe*>(self)->turn(std::span<const RadarObj>(radar, count));
+}
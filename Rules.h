@@ -0,0 +1,129 @@
+#pragma once
+#include <array>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+
+#include "RobotBase.h"
+
+// The game's weapon and obstacle numbers in one place. An arena plays by the
+// Rules in its GameConfig, so a variant for an experiment is a different
+// Rules value, not a change to Arena.cpp.
+
+// Cells a shot covers. The first three are placed around the aimed cell;
+// ray and flame travel from the shooter along the line through the aimed
+// cell, stepping one cell at a time along the longer axis and rounding the
+// other to the nearest cell. No shape hits the robot that fired it.
+enum class ShotShape : uint8_t {
+    cell,    // the aimed cell only
+    area,    // the 3x3 block centred on it
+    cross,   // its whole row and column
+    ray,     // every cell on the line, through anything in the way
+    flame,   // the line widened by a cell either side across it: 3 cells wide
+};
+
+struct WeaponRule {
+    int minDamage;   // raw damage is drawn from minDamage..maxDamage, once per shot
+    int maxDamage;
+    ShotShape shape;
+    int range;       // cell, area, cross: furthest aimed cell, in king moves from
+                     // the shooter. ray, flame: how many cells the shot travels.
+                     // 0 = no limit (a ray or flame stops at the board edge)
+    int ammo;        // shots per match; 0 = unlimited
+};
+
+// Whether the shot travels from the shooter rather than landing on the aimed cell
+constexpr bool travels(ShotShape shape) { return shape == ShotShape::ray || shape == ShotShape::flame; }
+
+// What entering a mound, flamethrower or pit cell does
+struct CellRule {
+    bool blocks;     // the move stops in front of it
+    bool traps;      // the move ends on it and the robot cannot move again
+    int minDamage;   // raw damage for stepping onto it, drawn like a shot's
+    int maxDamage;
+};
+
+struct Rules {
+    const char* name;
+    std::array<WeaponRule, 4> weapons; // by WeaponType
+    CellRule mound;
+    CellRule flamethrower;
+    CellRule pit;
+    int armorLossPerHit;               // armor a robot loses each time it takes damage
+
+    const WeaponRule& weapon(WeaponType w) const { return weapons[static_cast<size_t>(w) & 3]; }
+
+    // nullptr for cells that are not obstacles
+    const CellRule* cell(char type) const {
+        switch (type) {
+            case 'M': return &mound;
+            case 'F': return &flamethrower;
+            case 'P': return &pit;
+            default: return nullptr;
+        }
+    }
+};
+
+// Each point of armor takes 10% off raw damage, rounded half up, so armor 10
+// and above stops everything. armor_scaled_damage[armor][raw] holds every
+// result, built at compile time; damage is a lookup instead of float math.
+inline constexpr int max_scaled_armor = 10;
+inline constexpr int max_raw_damage = 255;
+
+inline constexpr auto armor_scaled_damage = [] {
+    std::array<std::array<uint8_t, max_raw_damage + 1>, max_scaled_armor + 1> t{};
+    for (int armor = 0; armor <= max_scaled_armor; ++armor)
+        for (int raw = 0; raw <= max_raw_damage; ++raw)
+            t[armor][raw] = static_cast<uint8_t>((raw * (max_scaled_armor - armor) + max_scaled_armor / 2) / max_scaled_armor);
+    return t;
+}();
+
+constexpr int armor_scaled(int raw, int armor) {
+    return armor_scaled_damage[std::clamp(armor, 0, max_scaled_armor)][std::clamp(raw, 0, max_raw_damage)];
+}
+
+static_assert(armor_scaled(10, 3) == 7 && armor_scaled(40, 5) == 20 && armor_scaled(15, 1) == 14);
+
+// The damage ranges and shot shapes from the game spec: the railgun goes
+// through everything to the edge of the board, the flame is 3 cells wide and
+// stops 4 cells from the robot, and the hammer only reaches a neighbouring cell
+inline constexpr Rules spec_rules{
+    "spec",
+    {{
+        {30, 50, ShotShape::flame, 4, 0},   // flamethrower
+        {10, 20, ShotShape::ray, 0, 0},     // railgun
+        {10, 40, ShotShape::area, 0, 10},   // grenade
+        {50, 60, ShotShape::cell, 1, 0},    // hammer
+    }},
+    {true, false, 0, 0},    // mound
+    {false, false, 30, 50}, // flamethrower
+    {false, true, 0, 0},    // pit
+    1,
+};
+
+// The placeholder numbers and shapes the arena used before the rules table:
+// 10 damage from every weapon, railgun shots down the aimed cell's row and
+// column, the rest a 3x3 block, and 40 from a flamethrower cell
+inline constexpr Rules legacy_rules{
+    "legacy",
+    {{
+        {10, 10, ShotShape::area, 0, 0},
+        {10, 10, ShotShape::cross, 0, 0},
+        {10, 10, ShotShape::area, 0, 0},
+        {10, 10, ShotShape::area, 0, 0},
+    }},
+    {true, false, 0, 0},
+    {false, false, 40, 40},
+    {false, true, 0, 0},
+    1,
+};
+
+inline constexpr const Rules* named_rules[] = {&spec_rules, &legacy_rules};
+
+// The built-in rule set with that name, or nullptr
+inline const Rules* find_rules(const std::string& name) {
+    for (const Rules* r : named_rules) {
+        if (name == r->name) return r;
+    }
+    return nullptr;
+}
@@ -0,0 +1,91 @@
+#include "StaticStateScan.h"
+#include <elf.h>
+#include <cxxabi.h>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+bool is_writable_data_section(const char* name) {
+    if (std::strncmp(name, ".data.rel.ro", 12) == 0) return false; // read-only after relocation
+    return std::strcmp(name, ".data") == 0 || std::strncmp(name, ".data.", 6) == 0 ||
+           std::strcmp(name, ".bss") == 0 || std::strncmp(name, ".bss.", 5) == 0 ||
+           std::strcmp(name, ".tdata") == 0 || std::strcmp(name, ".tbss") == 0;
+}
+
+// Objects every shared library carries, whichever robot it holds, and the
+// profile counters and libgcov globals of an instrumented
+// (OPT_PROFILE=pgo-train) build
+bool is_runtime_symbol(const char* name) {
+    static const char* const prefixes[] = {
+        "__dso_handle", "__TMC_END__", "completed.", "DW.ref.", "_ZStL8__ioinit", "_ZGV", "__gcov"
+    };
+    for (const char* p : prefixes) {
+        if (std::strncmp(name, p, std::strlen(p)) == 0) return true;
+    }
+    return false;
+}
+
+std::string demangle(const char* name) {
+    int status = 0;
+    char* out = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if (status != 0 || !out) return name;
+    std::string result(out);
+    std::free(out);
+    return result;
+}
+
+} // namespace
+
+bool find_writable_statics(const std::string& soPath, std::vector<std::string>& symbols) {
+    symbols.clear();
+
+    std::ifstream in(soPath, std::ios::binary);
+    if (!in) return false;
+    std::string image((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    if (image.size() < sizeof(Elf64_Ehdr)) return false;
+    const char* base = image.data();
+    const auto* eh = reinterpret_cast<const Elf64_Ehdr*>(base);
+    if (std::memcmp(eh->e_ident, ELFMAG, SELFMAG) != 0 || eh->e_ident[EI_CLASS] != ELFCLASS64) return false;
+    if (eh->e_shoff == 0 || eh->e_shoff + eh->e_shnum * sizeof(Elf64_Shdr) > image.size()) return false;
+
+    const auto* sh = reinterpret_cast<const Elf64_Shdr*>(base + eh->e_shoff);
+    auto in_image = [&](const Elf64_Shdr& s) { return s.sh_type == SHT_NOBITS || s.sh_offset + s.sh_size <= image.size(); };
+    if (eh->e_shstrndx >= eh->e_shnum || !in_image(sh[eh->e_shstrndx])) return false;
+    const char* shstr = base + sh[eh->e_shstrndx].sh_offset;
+
+    std::vector<bool> writable(eh->e_shnum, false);
+    const Elf64_Shdr* symtab = nullptr;
+    for (int i = 0; i < eh->e_shnum; ++i) {
+        if (!in_image(sh[i])) continue;
+        writable[i] = (sh[i].sh_flags & SHF_WRITE) && (sh[i].sh_flags & SHF_ALLOC) &&
+                      is_writable_data_section(shstr + sh[i].sh_name);
+        // prefer the full symbol table; fall back to the dynamic one on stripped libraries
+        if (sh[i].sh_type == SHT_SYMTAB || (sh[i].sh_type == SHT_DYNSYM && !symtab)) symtab = &sh[i];
+    }
+    if (!symtab || symtab->sh_link >= eh->e_shnum || !in_image(sh[symtab->sh_link])) return false;
+
+    const char* strtab = base + sh[symtab->sh_link].sh_offset;
+    const auto* syms = reinterpret_cast<const Elf64_Sym*>(base + symtab->sh_offset);
+    size_t count = symtab->sh_size / sizeof(Elf64_Sym);
+
+    // local symbols follow the FILE symbol of the object they came from
+    const char* file = "";
+    for (size_t i = 0; i < count; ++i) {
+        const Elf64_Sym& s = syms[i];
+        int type = ELF64_ST_TYPE(s.st_info);
+        if (type == STT_FILE) file = strtab + s.st_name;
+        if ((type != STT_OBJECT && type != STT_TLS) || s.st_size == 0) continue;
+        if (s.st_shndx == SHN_UNDEF || s.st_shndx >= eh->e_shnum || !writable[s.st_shndx]) continue;
+
+        const char* name = strtab + s.st_name;
+        if (is_runtime_symbol(name)) continue;
+        // libgcov's own state (its objects are _gcov*.o) in an instrumented build
+        if (ELF64_ST_BIND(s.st_info) == STB_LOCAL && std::strncmp(file, "_gcov", 5) == 0) continue;
+        symbols.push_back(demangle(name));
+    }
+    return true;
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Lists the writable static objects a compiled robot library defines: the
+// named objects in its .data/.bss (and TLS) sections, such as globals, class
+// statics and function-local statics. Compiler and runtime bookkeeping
+// (__dso_handle, iostream init, ...) is left out. Names are demangled.
+// Returns false if the file is not a readable 64-bit ELF object.
+bool find_writable_statics(const std::string& soPath, std::vector<std::string>& symbols);
@@ -0,0 +1,7 @@
+#include "ThreadCpuClock.h"
+
+long long ThreadCpuClock::now_ns() {
+    timespec ts{};
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+    return static_cast<long long>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
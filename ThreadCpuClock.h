@@ -0,0 +1,11 @@
+#pragma once
+#include <ctime>
+
+// The calling thread's CPU clock. The arena reads it before and after each
+// robot call to charge the robot's budgets; the clock is per thread and
+// nothing else is shared, so arenas on different threads never contend.
+class ThreadCpuClock {
+public:
+    // CPU time used so far by the calling thread
+    static long long now_ns();
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+
+// Fixed set of worker threads for fan-out/fan-in work. run(count, fn) calls
+// fn(0) .. fn(count - 1) spread over the workers and the calling thread and
+// returns once every call has finished; the first exception thrown by a call
+// is rethrown to the caller. One run() at a time per pool.
+class ThreadPool {
+public:
+    // threads == 0 uses one per hardware thread; the caller counts as one
+    explicit ThreadPool(unsigned threads = 0) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 1; i < threads; ++i) m_workers.emplace_back([this] { worker(); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto& t : m_workers) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return m_workers.size() + 1; }
+
+    void run(size_t count, const std::function<void(size_t)>& fn) {
+        if (count == 0) return;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_job = &fn;
+            m_count = count;
+            m_next = 0;
+            m_busy = m_workers.size();
+            m_error = nullptr;
+            ++m_generation;
+        }
+        m_wake.notify_all();
+
+        work();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_busy == 0; });
+        m_job = nullptr;
+        if (m_error) std::rethrow_exception(m_error);
+    }
+
+private:
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    const std::function<void(size_t)>* m_job = nullptr;
+    size_t m_count = 0;
+    std::atomic<size_t> m_next{0};
+    size_t m_busy = 0;
+    size_t m_generation = 0;
+    bool m_stop = false;
+    std::exception_ptr m_error;
+
+    // Claims indices until the current job runs out
+    void work() {
+        for (size_t i = m_next++; i < m_count; i = m_next++) {
+            try {
+                (*m_job)(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_error) m_error = std::current_exception();
+            }
+        }
+    }
+
+    void worker() {
+        size_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+                if (m_stop) return;
+                seen = m_generation;
+            }
+            work();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (--m_busy == 0) m_done.notify_one();
+            }
+        }
+    }
+};
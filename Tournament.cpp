@@ -0,0 +1,373 @@
+#include "Tournament.h"
+#include <iostream>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+#include <map>
+#include <thread>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/prctl.h>
+#include <csignal>
+#include <pthread.h>
+
+#include "ThreadPool.h"
+#include "ResultsSlab.h"
+
+Tournament::Tournament(const std::vector<RobotFactoryEntry>& roster_in, const TournamentConfig& cfg_in,
+                       RatingTable& ratings_in)
+    : roster(roster_in), cfg(cfg_in), ratings(ratings_in) {
+    for (const auto& entry : roster) ratings.add(entry.name);
+    // the results writer is opened by run(), after a resume has trimmed the file
+    if (!cfg.resultsPath.empty()) cfg.game.timeRobots = true;
+}
+
+int Tournament::run() {
+    if (static_cast<int>(roster.size()) < cfg.robotsPerMatch) {
+        std::cerr << "Need at least " << cfg.robotsPerMatch << " robots, have " << roster.size() << "\n";
+        return 0;
+    }
+
+    std::vector<char> done(static_cast<size_t>(std::max(0, cfg.matches)), 0);
+    if (!cfg.checkpointPath.empty()) {
+        if (!resume(done)) return 0;
+        if (finished) return played;
+    } else if (!cfg.resultsPath.empty()) {
+        store = std::make_unique<results::Writer>(cfg.resultsPath);
+        if (!store->ok()) return 0;
+    }
+
+    std::vector<int> todo;
+    for (size_t i = 0; i < done.size(); ++i) {
+        if (!done[i]) todo.push_back(static_cast<int>(i));
+    }
+
+    if (cfg.forkBatch > 0) {
+        run_forked(todo);
+    } else {
+        ThreadPool pool(cfg.threads);
+        pool.run(todo.size(), [&](size_t i) {
+            if (play_match(todo[i])) ++played;
+        });
+    }
+    if (checkpoint) {
+        save_checkpoint();
+        checkpoint->mark_finished();
+    } else if (store) {
+        store->flush();
+    }
+    return played;
+}
+
+// Same tournament means same settings, schedule and robots: the names, and
+// the compiled libraries byte for byte
+uint64_t Tournament::fingerprint() const {
+    uint64_t h = 1469598103934665603ULL;
+    auto mix = [&](const void* p, size_t n) {
+        const unsigned char* b = static_cast<const unsigned char*>(p);
+        for (size_t i = 0; i < n; ++i) {
+            h ^= b[i];
+            h *= 1099511628211ULL;
+        }
+    };
+    uint64_t game = config_hash(cfg.game);
+    mix(&game, sizeof(game));
+    mix(&cfg.seed, sizeof(cfg.seed));
+    mix(&cfg.matches, sizeof(cfg.matches));
+    mix(&cfg.robotsPerMatch, sizeof(cfg.robotsPerMatch));
+    mix(&cfg.adaptive, sizeof(cfg.adaptive));
+    for (const auto& entry : roster) {
+        mix(entry.name.data(), entry.name.size() + 1);
+        if (entry.library.empty()) continue;
+        std::ifstream in(entry.library, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        mix(bytes.data(), bytes.size());
+    }
+    return h;
+}
+
+// Opens the checkpoint, trims the results file back to what the checkpoint
+// vouches for and replays the logged matches
+bool Tournament::resume(std::vector<char>& done) {
+    std::error_code ec;
+    uint64_t resultsBytes = 0;
+    if (!cfg.resultsPath.empty() && std::filesystem::exists(cfg.resultsPath, ec)) {
+        resultsBytes = std::filesystem::file_size(cfg.resultsPath, ec);
+    }
+
+    checkpoint = std::make_unique<TournamentCheckpoint>();
+    if (!checkpoint->open(cfg.checkpointPath, fingerprint(), resultsBytes)) return false;
+    if (checkpoint->finished()) {
+        std::cout << "Checkpoint " << cfg.checkpointPath << ": tournament already finished\n";
+        finished = true;
+        return true;
+    }
+
+    size_t inResults = checkpoint->matches_in_results();
+    bool rewrite = false;
+    if (!cfg.resultsPath.empty()) {
+        // The checkpoint vouches for results_bytes() of the file, but only if
+        // that much still reads back as whole blocks. If not (the file lost
+        // data it was never synced with, or was damaged since), everything
+        // this tournament wrote is dropped and rewritten from the checkpoint.
+        uint64_t keep = checkpoint->results_bytes();
+        size_t intact = results::Reader(cfg.resultsPath).valid_bytes();
+        if (intact < keep) {
+            keep = checkpoint->start_results_bytes();
+            if (intact < keep) {
+                std::cerr << "Results file " << cfg.resultsPath << " has lost results from before this tournament; "
+                          << "not resuming\n";
+                return false;
+            }
+            std::cerr << "Results file " << cfg.resultsPath << " is missing results the checkpoint recorded; "
+                      << "rewriting this tournament's matches\n";
+            inResults = 0;
+            rewrite = true;
+        }
+
+        // blocks written after the last results record may be partial or
+        // hold matches the checkpoint never logged; they are rewritten below
+        if (resultsBytes > keep) {
+            std::filesystem::resize_file(cfg.resultsPath, keep, ec);
+            if (ec) {
+                std::cerr << "Cannot trim results file " << cfg.resultsPath << ": " << ec.message() << "\n";
+                return false;
+            }
+        }
+        store = std::make_unique<results::Writer>(cfg.resultsPath);
+        if (!store->ok()) return false;
+    }
+
+    const auto& completed = checkpoint->completed();
+    for (size_t i = 0; i < completed.size(); ++i) {
+        const auto& m = completed[i];
+        if (m.matchNo < 0 || m.matchNo >= static_cast<int>(done.size()) || done[m.matchNo]) continue;
+        done[m.matchNo] = 1;
+        ratings.record(m.result);
+        rounds += m.result.rounds;
+        if (m.result.endReason == EndReason::repeated_state || m.result.endReason == EndReason::unreachable) ++stalled;
+        if (store && i >= inResults) store->append(m.result);
+        ++played;
+    }
+    // the old results record points into the part that was dropped
+    if (rewrite) save_checkpoint();
+    if (!completed.empty()) {
+        std::cout << "Checkpoint " << cfg.checkpointPath << ": resuming after " << played << " of "
+                  << cfg.matches << " matches\n";
+    }
+    lastSync = std::chrono::steady_clock::now();
+    return true;
+}
+
+// Everything recorded so far goes to disk: results first, then the
+// checkpoint that points at them. Results that could not be synced are not
+// vouched for; the last results record stands and the matches logged since
+// are rewritten on resume.
+void Tournament::save_checkpoint() {
+    if (store && store->sync()) checkpoint->mark_results(store->file_size());
+    checkpoint->sync();
+    lastSync = std::chrono::steady_clock::now();
+}
+
+bool Tournament::play_match(int matchNo) {
+    std::vector<std::string> players = pick_players(matchNo);
+    MatchResult result;
+    if (!play(matchNo, players, result)) {
+        ratings.release(players);
+        return false;
+    }
+    record_result(matchNo, result);
+    return true;
+}
+
+std::vector<std::string> Tournament::pick_players(int matchNo) {
+    std::mt19937 rng(cfg.seed + matchNo);
+    return ratings.pick_match(cfg.robotsPerMatch, rng, cfg.adaptive);
+}
+
+// Plays one match between players. False if it could not be played fairly;
+// the caller releases the players.
+bool Tournament::play(int matchNo, const std::vector<std::string>& players, MatchResult& result) {
+    std::vector<RobotFactoryEntry> entries;
+    for (const auto& name : players) {
+        auto it = std::find_if(roster.begin(), roster.end(), [&](const RobotFactoryEntry& e) { return e.name == name; });
+        if (it != roster.end()) entries.push_back(*it);
+    }
+
+    GameConfig game = cfg.game;
+    game.rngSeed = cfg.seed + matchNo;
+    game.liveView = false;
+    game.quiet = true;
+    // matches already run one per worker; a decision pool per arena would
+    // start a thread per core for every match in flight
+    game.decisionThreads = 1;
+
+    Arena arena(game);
+    if (players.empty() || entries.size() != players.size() || !arena.load_robots(entries)) return false;
+
+    result = arena.run();
+    // a robot failed to load; the rest of the match is not a fair result
+    return result.robots.size() == players.size();
+}
+
+// Fork mode. The roster's libraries (and any map) are already loaded, so a
+// worker forked from here starts with all of it shared copy-on-write and
+// plays its batch straight away. The pairings are picked here, where the
+// ratings live, and each worker reports through its own region of a shared
+// ResultsSlab. A worker that crashes, or is killed for running past its
+// batch's deadline, gives up the match it was playing; the matches of its
+// batch it never started are queued again and the run goes on.
+void Tournament::run_forked(const std::vector<int>& todo) {
+    size_t workers = cfg.threads ? cfg.threads : std::max(1u, std::thread::hardware_concurrency());
+    size_t batch = static_cast<size_t>(std::max(1, cfg.forkBatch));
+    ResultsSlab slab(workers, batch, static_cast<size_t>(cfg.robotsPerMatch));
+    if (!slab.ok()) return;
+
+    using Clock = std::chrono::steady_clock;
+    struct Worker {
+        size_t region;
+        std::vector<int> matches;
+        std::vector<std::vector<std::string>> players;
+        Clock::time_point deadline;
+        bool killed = false;
+    };
+    std::map<pid_t, Worker> running;
+    std::vector<size_t> freeRegions;
+    for (size_t r = workers; r-- > 0;) freeRegions.push_back(r);
+
+    // SIGCHLD stays pending while blocked, so the wait below can sleep until
+    // a worker exits or the nearest deadline, whichever comes first
+    sigset_t childSignal, oldMask;
+    sigemptyset(&childSignal);
+    sigaddset(&childSignal, SIGCHLD);
+    pthread_sigmask(SIG_BLOCK, &childSignal, &oldMask);
+
+    std::vector<int> queue = todo; // retried matches go on the end
+    pid_t parent = getpid();
+    size_t next = 0;
+    while (next < queue.size() || !running.empty()) {
+        while (!freeRegions.empty() && next < queue.size()) {
+            Worker w{freeRegions.back(), {}, {}, {}};
+            for (; next < queue.size() && w.matches.size() < batch; ++next) {
+                w.matches.push_back(queue[next]);
+                w.players.push_back(pick_players(queue[next]));
+            }
+            w.deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                            std::chrono::duration<double>(cfg.matchSeconds * w.matches.size()));
+            slab.clear(w.region);
+
+            // nothing buffered may be written twice
+            std::cout.flush();
+            std::cerr.flush();
+            pid_t pid = fork();
+            if (pid == 0) {
+                // Nobody collects a batch once the parent is gone, and the
+                // worker shares its lock on the results file: go with it
+                prctl(PR_SET_PDEATHSIG, SIGKILL);
+                if (getppid() != parent) _exit(1);
+                pthread_sigmask(SIG_SETMASK, &oldMask, nullptr);
+                for (size_t i = 0; i < w.matches.size(); ++i) {
+                    MatchResult result;
+                    if (play(w.matches[i], w.players[i], result)) slab.put(w.region, i, w.matches[i], result, roster);
+                }
+                // no destructors or atexit handlers: those belong to the parent
+                _exit(0);
+            }
+            if (pid < 0) {
+                std::cerr << "fork failed: " << std::strerror(errno) << "\n";
+                for (const auto& players : w.players) ratings.release(players);
+                break;
+            }
+            freeRegions.pop_back();
+            running.emplace(pid, std::move(w));
+        }
+        if (running.empty()) break;
+
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, WNOHANG);
+        if (pid < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "waitpid failed: " << std::strerror(errno) << "\n";
+            break;
+        }
+        if (pid == 0) {
+            // Nobody has exited: kill the workers past their deadline, then
+            // sleep until the next exit or deadline
+            Clock::time_point now = Clock::now(), wake = Clock::time_point::max();
+            for (auto& [wpid, w] : running) {
+                if (cfg.matchSeconds <= 0 || w.killed) continue;
+                if (now >= w.deadline) {
+                    kill(wpid, SIGKILL);
+                    w.killed = true;
+                } else {
+                    wake = std::min(wake, w.deadline);
+                }
+            }
+            if (wake == Clock::time_point::max()) {
+                sigwaitinfo(&childSignal, nullptr);
+            } else {
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wake - now).count();
+                timespec timeout{static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000)};
+                sigtimedwait(&childSignal, nullptr, &timeout);
+            }
+            continue;
+        }
+        auto it = running.find(pid);
+        if (it == running.end()) continue;
+        Worker& w = it->second;
+
+        // The worker plays its batch in order: everything after the last
+        // result it reported was either being played when it died or never
+        // started
+        size_t reported = 0;
+        std::vector<char> taken(w.matches.size(), 0);
+        for (size_t i = 0; i < w.matches.size(); ++i) {
+            int matchNo = -1;
+            MatchResult result;
+            if (slab.take(w.region, i, roster, matchNo, result) && matchNo == w.matches[i]) {
+                record_result(matchNo, result);
+                ++played;
+                taken[i] = 1;
+                reported = i + 1;
+            }
+        }
+        bool failed = WIFSIGNALED(status) || (WIFEXITED(status) && WEXITSTATUS(status) != 0);
+        int lost = 0, retried = 0;
+        for (size_t i = 0; i < w.matches.size(); ++i) {
+            if (taken[i]) continue;
+            ratings.release(w.players[i]);
+            if (failed && i > reported) {
+                queue.push_back(w.matches[i]);
+                ++retried;
+            } else if (!w.players[i].empty()) {
+                ++lost;
+            }
+        }
+        if (failed) {
+            std::cerr << "Worker for " << w.matches.size() << " matches from match " << w.matches.front() << " ";
+            if (w.killed) std::cerr << "ran past its deadline and was killed";
+            else if (WIFSIGNALED(status)) std::cerr << "killed by signal " << WTERMSIG(status);
+            else std::cerr << "exited with " << WEXITSTATUS(status);
+            std::cerr << ", " << lost << " of its matches lost, " << retried << " queued again\n";
+        }
+        freeRegions.push_back(w.region);
+        running.erase(it);
+    }
+    pthread_sigmask(SIG_SETMASK, &oldMask, nullptr);
+}
+
+void Tournament::record_result(int matchNo, const MatchResult& result) {
+    std::lock_guard<std::mutex> lock(recordMutex);
+    ratings.record(result);
+    rounds += result.rounds;
+    if (result.endReason == EndReason::repeated_state || result.endReason == EndReason::unreachable) ++stalled;
+    if (store) store->append(result);
+    if (checkpoint) {
+        checkpoint->append_match(matchNo, result);
+        std::chrono::duration<double> since = std::chrono::steady_clock::now() - lastSync;
+        if (since.count() >= cfg.checkpointSeconds) save_checkpoint();
+    }
+}
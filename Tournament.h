@@ -0,0 +1,70 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <chrono>
+
+#include "Arena.h"
+#include "Ratings.h"
+#include "ResultsStore.h"
+#include "Checkpoint.h"
+
+struct TournamentConfig {
+    GameConfig game;          // settings for every match; the seed is set per match
+    int matches = 100;
+    int robotsPerMatch = 2;
+    unsigned threads = 0;     // matches played at once; 0 = one per core
+    unsigned seed = 1;        // match i uses seed + i for its arena
+    bool adaptive = true;     // let the rating table pick informative pairings
+    std::string resultsPath;  // append every match to this results file when set
+    std::string checkpointPath;    // log progress here and resume from it when set
+    double checkpointSeconds = 10; // how often the checkpoint is fsynced
+    int forkBatch = 0;        // > 0: play in forked worker processes, this many matches each,
+                              // with `threads` of them running at once
+    double matchSeconds = 10; // fork mode: wall-clock time a worker gets per match of its batch;
+                              // past that it is killed. 0 = no deadline
+};
+
+// Plays quiet matches between robots from an already loaded roster on a
+// thread pool, or in forked worker processes so a crashing robot only costs
+// its worker's batch, and feeds each result into a RatingTable.
+// With a checkpoint, a run that was killed picks up where it stopped: the
+// logged matches are replayed into the ratings and only the rest are played.
+class Tournament {
+public:
+    Tournament(const std::vector<RobotFactoryEntry>& roster, const TournamentConfig& cfg, RatingTable& ratings);
+
+    // Plays cfg.matches matches; returns how many produced a result,
+    // counting the ones a checkpoint had already logged
+    int run();
+
+    // The checkpoint says an earlier run played every match; run() did nothing
+    bool already_finished() const { return finished; }
+
+    long long rounds_played() const { return rounds; }
+    int stalemates() const { return stalled; }
+
+private:
+    std::vector<RobotFactoryEntry> roster;
+    TournamentConfig cfg;
+    RatingTable& ratings;
+    std::atomic<int> played{0};
+    std::atomic<long long> rounds{0};
+    std::atomic<int> stalled{0};     // matches cut short by stalemate detection
+    std::unique_ptr<results::Writer> store;
+    std::unique_ptr<TournamentCheckpoint> checkpoint;
+    std::mutex recordMutex;          // keeps ratings, store and checkpoint in the same order
+    std::chrono::steady_clock::time_point lastSync;
+    bool finished = false;
+
+    bool play_match(int matchNo);
+    std::vector<std::string> pick_players(int matchNo);
+    bool play(int matchNo, const std::vector<std::string>& players, MatchResult& result);
+    void run_forked(const std::vector<int>& todo);
+    void record_result(int matchNo, const MatchResult& result);
+    bool resume(std::vector<char>& done);
+    void save_checkpoint();
+    uint64_t fingerprint() const;
+};
@@ -0,0 +1,573 @@
+#include "Arena.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <optional>
+#include <algorithm>
+#include <tuple>
+#include <iterator>
+
+// Differential fuzzer: plays the same match on the optimized engine and on
+// the reference engine (ArenaReference.cpp) in lockstep and compares every
+// turn - the robot's radar scan and decision, each robot's stats and the
+// board. Placement is compared by what it produced (obstacle counts, robots
+// on free cells), since the two placement paths draw from the RNG
+// differently; both engines then continue from the same snapshot.
+//
+// The robots are scripted fuzz robots whose choices come from their own
+// seeded RNG, so both engines see identical robot behaviour. A divergence is
+// shrunk (fewer robots, rounds and obstacles, smaller board) and printed as a
+// case string that --replay runs again.
+//
+// usage: engine_fuzz [-n cases] [-s seed] [--replay CASE]
+// Needs the reference engine: built with -DROBOTWARZ_REFERENCE_ENGINE.
+
+#ifndef ROBOTWARZ_REFERENCE_ENGINE
+#error "engine_fuzz needs the reference engine (-DROBOTWARZ_REFERENCE_ENGINE)"
+#endif
+
+namespace {
+
+struct FuzzSpec {
+    int move = 3;
+    int armor = 2;
+    int weapon = 0;
+    unsigned seed = 1;
+};
+
+struct FuzzCase {
+    int rows = 20, cols = 20;
+    int mounds = 0, pits = 0, flamers = 0;
+    int rounds = 50;
+    unsigned seed = 1;
+    bool simultaneous = false;
+    std::string rules = spec_rules.name; // one of the built-in rule sets
+    std::vector<FuzzSpec> roster;
+    // Fixed start position instead of seeded placement, one string per row:
+    // '.', 'M', 'F', 'P' or the digit of the robot standing there
+    std::vector<std::string> layout;
+};
+
+constexpr int max_robots = 8;
+std::vector<FuzzSpec> g_specs(max_robots);
+long long g_turns = 0; // turns compared so far
+
+// Random but reproducible robot: radar in a random direction, shoot near a
+// robot it saw (sometimes anywhere, sometimes off the board), otherwise move
+class FuzzRobot : public RobotBase {
+public:
+    explicit FuzzRobot(const FuzzSpec& s)
+        : RobotBase(s.move, s.armor, static_cast<WeaponType>(s.weapon)), rng(s.seed) {}
+
+    void get_radar_direction(int& dir) override { dir = static_cast<int>(rng() % 9); }
+
+    void process_radar_results(const std::vector<RadarObj>& results) override {
+        seen.clear();
+        for (const auto& obj : results) if (obj.m_type == 'R') seen.push_back(obj);
+    }
+
+    bool get_shot_location(int& r, int& c) override {
+        unsigned roll = rng() % 100;
+        if (!seen.empty() && roll < 60) {
+            const auto& t = seen[rng() % seen.size()];
+            r = t.m_row + static_cast<int>(rng() % 3) - 1;
+            c = t.m_col + static_cast<int>(rng() % 3) - 1;
+            return true;
+        }
+        if (roll < 70) {
+            r = static_cast<int>(rng() % std::max(1, m_board_row_max));
+            c = static_cast<int>(rng() % std::max(1, m_board_col_max));
+            return true;
+        }
+        if (roll < 71) {
+            r = -1;
+            c = m_board_col_max;
+            return true;
+        }
+        return false;
+    }
+
+    void get_move_direction(int& dir, int& dist) override {
+        dir = static_cast<int>(rng() % 9);
+        dist = static_cast<int>(rng() % 7);
+    }
+
+private:
+    std::mt19937 rng;
+    std::vector<RadarObj> seen;
+};
+
+template <int K>
+RobotBase* make_fuzz_robot() { return new FuzzRobot(g_specs[K]); }
+
+const RobotFactory fuzz_factories[max_robots] = {
+    make_fuzz_robot<0>, make_fuzz_robot<1>, make_fuzz_robot<2>, make_fuzz_robot<3>,
+    make_fuzz_robot<4>, make_fuzz_robot<5>, make_fuzz_robot<6>, make_fuzz_robot<7>,
+};
+
+std::string to_string(const FuzzCase& fc) {
+    std::ostringstream out;
+    out << "rows=" << fc.rows << " cols=" << fc.cols << " mounds=" << fc.mounds << " pits=" << fc.pits
+        << " flamers=" << fc.flamers << " rounds=" << fc.rounds << " seed=" << fc.seed
+        << " sim=" << fc.simultaneous << " rules=" << fc.rules << " robots=";
+    for (size_t i = 0; i < fc.roster.size(); ++i) {
+        const auto& s = fc.roster[i];
+        out << (i ? "," : "") << s.move << ":" << s.armor << ":" << s.weapon << ":" << s.seed;
+    }
+    if (!fc.layout.empty()) {
+        out << " layout=";
+        for (size_t r = 0; r < fc.layout.size(); ++r) out << (r ? "/" : "") << fc.layout[r];
+    }
+    return out.str();
+}
+
+std::optional<FuzzCase> parse_case(const std::string& text) {
+    FuzzCase fc;
+    std::istringstream in(text);
+    std::string field;
+    while (in >> field) {
+        auto eq = field.find('=');
+        if (eq == std::string::npos) return std::nullopt;
+        std::string key = field.substr(0, eq), value = field.substr(eq + 1);
+        if (key == "robots") {
+            std::istringstream list(value);
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                FuzzSpec s;
+                char sep;
+                std::istringstream one(item);
+                if (!(one >> s.move >> sep >> s.armor >> sep >> s.weapon >> sep >> s.seed)) return std::nullopt;
+                fc.roster.push_back(s);
+            }
+            continue;
+        }
+        if (key == "rules") {
+            if (!find_rules(value)) return std::nullopt;
+            fc.rules = value;
+            continue;
+        }
+        if (key == "layout") {
+            std::istringstream rows(value);
+            std::string row;
+            while (std::getline(rows, row, '/')) fc.layout.push_back(row);
+            continue;
+        }
+        long long v = std::stoll(value);
+        if (key == "rows") fc.rows = static_cast<int>(v);
+        else if (key == "cols") fc.cols = static_cast<int>(v);
+        else if (key == "mounds") fc.mounds = static_cast<int>(v);
+        else if (key == "pits") fc.pits = static_cast<int>(v);
+        else if (key == "flamers") fc.flamers = static_cast<int>(v);
+        else if (key == "rounds") fc.rounds = static_cast<int>(v);
+        else if (key == "seed") fc.seed = static_cast<unsigned>(v);
+        else if (key == "sim") fc.simultaneous = v != 0;
+        else return std::nullopt;
+    }
+    if (fc.roster.size() < 2 || fc.roster.size() > max_robots) return std::nullopt;
+    if (!fc.layout.empty()) {
+        fc.rows = static_cast<int>(fc.layout.size());
+        fc.cols = static_cast<int>(fc.layout[0].size());
+        for (const auto& row : fc.layout) if (static_cast<int>(row.size()) != fc.cols) return std::nullopt;
+    }
+    return fc;
+}
+
+FuzzCase random_case(std::mt19937& rng) {
+    auto pick = [&](int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(rng); };
+    FuzzCase fc;
+    // sizes straddle the 64-cell board tiles; some are the sizes with
+    // compile-time specialized paths
+    fc.rows = pick(3, rng() % 4 == 0 ? 150 : 40);
+    fc.cols = pick(3, rng() % 4 == 0 ? 150 : 40);
+    if (rng() % 4 == 0) {
+        std::tie(fc.rows, fc.cols) = specialized_board_sizes[rng() % std::size(specialized_board_sizes)];
+    }
+    int cells = fc.rows * fc.cols;
+    fc.mounds = pick(0, cells / 10);
+    fc.pits = pick(0, cells / 20);
+    fc.flamers = pick(0, cells / 20);
+    fc.rounds = pick(10, 120);
+    fc.seed = static_cast<unsigned>(rng());
+    fc.simultaneous = rng() % 4 == 0;
+    fc.rules = named_rules[rng() % std::size(named_rules)]->name;
+    int robots = pick(2, std::min(max_robots, std::max(2, cells / 4)));
+    for (int i = 0; i < robots; ++i) {
+        fc.roster.push_back({pick(2, 5), pick(0, 4), pick(0, 3), static_cast<unsigned>(rng())});
+    }
+    return fc;
+}
+
+// What one robot's turn did, as seen from outside the engine
+struct TurnRecord {
+    int robot = -1;
+    TurnDecision decision;
+    std::vector<RobotSnapshot> robots;
+    PlayingBoard board{1, 1};
+    uint64_t hash = 0;
+};
+
+bool same_radar(const std::vector<RadarObj>& a, const std::vector<RadarObj>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].m_type != b[i].m_type || a[i].m_row != b[i].m_row || a[i].m_col != b[i].m_col) return false;
+    }
+    return true;
+}
+
+bool same_robot(const RobotSnapshot& a, const RobotSnapshot& b) {
+    return a.row == b.row && a.col == b.col && a.alive == b.alive && a.health == b.health && a.armor == b.armor &&
+           a.move == b.move && a.grenades == b.grenades && a.damageDealt == b.damageDealt &&
+           a.damageTaken == b.damageTaken && a.shotsFired == b.shotsFired;
+}
+
+std::string describe_robot(const RobotSnapshot& s) {
+    std::ostringstream out;
+    out << "(" << s.row << "," << s.col << ") " << (s.alive ? "alive" : "dead") << " health " << s.health
+        << " armor " << s.armor << " move " << s.move << " grenades " << s.grenades << " shots " << s.shotsFired;
+    return out.str();
+}
+
+// First difference between two turns, or empty when they agree
+std::string compare_turns(const TurnRecord& fast, const TurnRecord& ref) {
+    std::ostringstream out;
+    if (fast.robot != ref.robot) {
+        out << "robot " << fast.robot << " acted, reference had robot " << ref.robot;
+        return out.str();
+    }
+    const TurnDecision& a = fast.decision;
+    const TurnDecision& b = ref.decision;
+    if (!same_radar(a.radar, b.radar)) {
+        out << "radar scan differs (" << a.radar.size() << " vs " << b.radar.size() << " cells)";
+        return out.str();
+    }
+    if (a.shoots != b.shoots || a.shotRow != b.shotRow || a.shotCol != b.shotCol || a.moveDir != b.moveDir ||
+        a.steps != b.steps || a.forfeit != b.forfeit) {
+        return "decision differs";
+    }
+    for (size_t i = 0; i < fast.robots.size() && i < ref.robots.size(); ++i) {
+        if (!same_robot(fast.robots[i], ref.robots[i])) {
+            out << "robot " << i << " is " << describe_robot(fast.robots[i]) << ", reference "
+                << describe_robot(ref.robots[i]);
+            return out.str();
+        }
+    }
+    for (int r = 0; r < fast.board.rows(); ++r) {
+        for (int c = 0; c < fast.board.cols(); ++c) {
+            const auto& x = fast.board.at(r, c);
+            const auto& y = ref.board.at(r, c);
+            if (x.type != y.type || x.robotIndex != y.robotIndex) {
+                out << "board (" << r << "," << c << ") is '" << x.type << "' robot " << x.robotIndex
+                    << ", reference '" << y.type << "' robot " << y.robotIndex;
+                return out.str();
+            }
+        }
+    }
+    if (fast.hash != ref.hash) return "state hash differs";
+    return "";
+}
+
+struct Divergence {
+    int round = 0;
+    std::string what;
+};
+
+// Obstacle counts per type and whether every robot sits on its own board cell
+std::string placement_summary(const ArenaSnapshot& s) {
+    int counts[3] = {0, 0, 0};
+    for (int r = 0; r < s.board.rows(); ++r) {
+        for (int c = 0; c < s.board.cols(); ++c) {
+            char t = s.board.at(r, c).type;
+            if (t == 'M') ++counts[0];
+            else if (t == 'P') ++counts[1];
+            else if (t == 'F') ++counts[2];
+        }
+    }
+    std::ostringstream out;
+    out << counts[0] << " mounds, " << counts[1] << " pits, " << counts[2] << " flamers";
+    for (size_t i = 0; i < s.robots.size(); ++i) {
+        const auto& rs = s.robots[i];
+        if (!s.board.in_bounds(rs.row, rs.col) || s.board.at(rs.row, rs.col).robotIndex != static_cast<int>(i)) {
+            out << ", robot " << i << " not on the board";
+        }
+    }
+    return out.str();
+}
+
+// The start position a case's layout describes, with fresh robot stats
+std::optional<ArenaSnapshot> layout_start(const FuzzCase& fc) {
+    ArenaSnapshot s{PlayingBoard(fc.rows, fc.cols), {}, std::mt19937(fc.seed), 1, {}, 0, 0, {}, {}};
+    s.robots.resize(fc.roster.size());
+    for (int r = 0; r < fc.rows; ++r) {
+        for (int c = 0; c < fc.cols; ++c) {
+            char t = fc.layout[r][c];
+            if (t >= '0' && t < '0' + static_cast<int>(fc.roster.size())) {
+                s.board.place_robot(r, c, t - '0');
+                s.robots[t - '0'].row = r;
+                s.robots[t - '0'].col = c;
+            } else if (t != '.') {
+                s.board.place_obstacle(r, c, t);
+            }
+        }
+    }
+    for (size_t i = 0; i < fc.roster.size(); ++i) {
+        auto& rs = s.robots[i];
+        if (rs.row < 0) return std::nullopt;
+        FuzzRobot fresh(fc.roster[i]);
+        rs.alive = true;
+        rs.health = fresh.get_health();
+        rs.armor = fresh.get_armor();
+        rs.move = fresh.get_move_speed();
+        rs.grenades = fresh.get_grenades();
+    }
+    return s;
+}
+
+// The inverse: a case pinned to the given start position
+FuzzCase with_layout(FuzzCase fc, const ArenaSnapshot& s) {
+    fc.mounds = fc.pits = fc.flamers = 0;
+    fc.layout.assign(s.board.rows(), std::string(s.board.cols(), '.'));
+    for (int r = 0; r < s.board.rows(); ++r) {
+        for (int c = 0; c < s.board.cols(); ++c) {
+            char t = s.board.at(r, c).type;
+            if (t == 'M' || t == 'F' || t == 'P') fc.layout[r][c] = t;
+        }
+    }
+    for (size_t i = 0; i < s.robots.size(); ++i) {
+        if (s.board.in_bounds(s.robots[i].row, s.robots[i].col)) {
+            fc.layout[s.robots[i].row][s.robots[i].col] = static_cast<char>('0' + i);
+        }
+    }
+    return fc;
+}
+
+std::optional<Divergence> run_case(const FuzzCase& fc, ArenaSnapshot* placed = nullptr) {
+    std::vector<RobotFactoryEntry> roster;
+    for (size_t i = 0; i < fc.roster.size(); ++i) {
+        g_specs[i] = fc.roster[i];
+        roster.push_back({"Fuzz" + std::to_string(i), fuzz_factories[i], "", false});
+    }
+
+    GameConfig cfg;
+    cfg.height = fc.rows;
+    cfg.width = fc.cols;
+    cfg.mounds = fc.mounds;
+    cfg.pits = fc.pits;
+    cfg.flamers = fc.flamers;
+    cfg.maxRounds = fc.rounds;
+    cfg.rngSeed = fc.seed;
+    cfg.simultaneousTurns = fc.simultaneous;
+    cfg.rules = *find_rules(fc.rules);
+    cfg.decisionThreads = 1;
+    cfg.liveView = false;
+    cfg.quiet = true;
+    GameConfig refCfg = cfg;
+    refCfg.referenceEngine = true;
+
+    Arena fast(cfg), ref(refCfg);
+    if (!fast.load_robots(roster) || !ref.load_robots(roster)) return Divergence{0, "robots failed to load"};
+
+    ArenaSnapshot start{PlayingBoard(1, 1), {}, {}, 1, {}, 0, 0, {}, {}};
+    if (!fc.layout.empty()) {
+        auto s = layout_start(fc);
+        if (!s) return Divergence{0, "layout is missing a robot"};
+        start = std::move(*s);
+    } else {
+        fast.place_obstacles();
+        fast.place_robots_randomly();
+        ref.place_obstacles();
+        ref.place_robots_randomly();
+        start = fast.snapshot();
+
+        // Only compare when both placements must succeed; on crowded boards the
+        // reference sampler may give up where the free-cell list does not
+        long long wanted = static_cast<long long>(fc.mounds) + fc.pits + fc.flamers + static_cast<long long>(fc.roster.size());
+        if (wanted * 2 <= static_cast<long long>(fc.rows) * fc.cols) {
+            std::string a = placement_summary(start), b = placement_summary(ref.snapshot());
+            if (a != b) return Divergence{0, "placement: " + a + "; reference: " + b};
+        }
+    }
+    if (placed) *placed = start;
+
+    // Both engines continue from the same start with fresh robots
+    if (!fast.restore(start) || !ref.restore(start)) return Divergence{0, "restore failed"};
+
+    std::vector<TurnRecord> fastTurns, refTurns;
+    auto observe = [](Arena& arena, std::vector<TurnRecord>& log) {
+        return [&arena, &log](int robotIdx, const TurnDecision& d) {
+            ArenaSnapshot s = arena.snapshot();
+            log.push_back({robotIdx, d, std::move(s.robots), std::move(s.board), arena.state_hash()});
+        };
+    };
+    fast.set_turn_observer(observe(fast, fastTurns));
+    ref.set_turn_observer(observe(ref, refTurns));
+
+    for (int round = 1; round <= fc.rounds; ++round) {
+        fast.play(round);
+        ref.play(round);
+        size_t n = std::min(fastTurns.size(), refTurns.size());
+        for (size_t i = 0; i < n; ++i) {
+            std::string diff = compare_turns(fastTurns[i], refTurns[i]);
+            if (!diff.empty()) return Divergence{round, "turn " + std::to_string(i + 1) + ": " + diff};
+        }
+        g_turns += static_cast<long long>(n);
+        if (fastTurns.size() != refTurns.size()) {
+            return Divergence{round, std::to_string(fastTurns.size()) + " turns played, reference played " +
+                                         std::to_string(refTurns.size())};
+        }
+        fastTurns.clear();
+        refTurns.clear();
+    }
+
+    MatchResult a = fast.result(), b = ref.result();
+    if (a.winner != b.winner || a.eliminated != b.eliminated || a.survivors != b.survivors) {
+        return Divergence{fc.rounds, "match results differ"};
+    }
+    return std::nullopt;
+}
+
+// Robot k taken out of a case; later robots move down one index
+FuzzCase without_robot(FuzzCase fc, size_t k) {
+    fc.roster.erase(fc.roster.begin() + k);
+    for (auto& row : fc.layout) {
+        for (char& t : row) {
+            if (t == static_cast<char>('0' + k)) t = '.';
+            else if (t > static_cast<char>('0' + k) && t <= '9') --t;
+        }
+    }
+    return fc;
+}
+
+// Greedy shrinking: pin the start position so that nothing moves while the
+// case is cut down, then keep any cut that still diverges - fewer rounds and
+// robots, obstacles removed in ever smaller chunks, rows and columns cropped
+FuzzCase shrink(FuzzCase fc, Divergence& div) {
+    auto fails = [&](const FuzzCase& c) {
+        auto d = run_case(c);
+        if (d) div = *d;
+        return d.has_value();
+    };
+
+    if (fc.layout.empty() && div.round > 0) {
+        ArenaSnapshot start{PlayingBoard(1, 1), {}, {}, 1, {}, 0, 0, {}, {}};
+        run_case(fc, &start);
+        FuzzCase pinned = with_layout(fc, start);
+        if (fails(pinned)) fc = pinned;
+    }
+
+    bool changed = true;
+    auto attempt = [&](const FuzzCase& c) {
+        if (!fails(c)) return false;
+        fc = c;
+        changed = true;
+        return true;
+    };
+
+    while (changed) {
+        changed = false;
+        if (div.round > 0 && div.round < fc.rounds) {
+            FuzzCase c = fc;
+            c.rounds = div.round;
+            attempt(c);
+        }
+        for (size_t k = 0; fc.roster.size() > 2 && k < fc.roster.size();) {
+            if (!attempt(without_robot(fc, k))) ++k;
+        }
+        if (fc.simultaneous) {
+            FuzzCase c = fc;
+            c.simultaneous = false;
+            attempt(c);
+        }
+        if (fc.layout.empty()) continue;
+
+        std::vector<std::pair<int,int>> obstacles;
+        for (int r = 0; r < fc.rows; ++r)
+            for (int c = 0; c < fc.cols; ++c)
+                if (std::string("MFP").find(fc.layout[r][c]) != std::string::npos) obstacles.emplace_back(r, c);
+        for (size_t chunk = obstacles.size(); chunk > 0; chunk /= 2) {
+            for (size_t first = 0; first < obstacles.size();) {
+                FuzzCase c = fc;
+                size_t last = std::min(obstacles.size(), first + chunk);
+                for (size_t i = first; i < last; ++i) c.layout[obstacles[i].first][obstacles[i].second] = '.';
+                if (attempt(c)) obstacles.erase(obstacles.begin() + first, obstacles.begin() + last);
+                else first = last;
+            }
+        }
+
+        // crop edges that hold no robot
+        auto robot_free = [](const std::string& cells) {
+            return cells.find_first_of("0123456789") == std::string::npos;
+        };
+        auto column = [&](int c) {
+            std::string cells;
+            for (const auto& row : fc.layout) cells += row[c];
+            return cells;
+        };
+        auto crop = [&](int top, int left, int rows, int cols) {
+            FuzzCase c = fc;
+            c.layout.clear();
+            for (int r = top; r < top + rows; ++r) c.layout.push_back(fc.layout[r].substr(left, cols));
+            c.rows = rows;
+            c.cols = cols;
+            return c;
+        };
+        while (fc.rows > 1 && robot_free(fc.layout.back()) && attempt(crop(0, 0, fc.rows - 1, fc.cols))) {}
+        while (fc.rows > 1 && robot_free(fc.layout.front()) && attempt(crop(1, 0, fc.rows - 1, fc.cols))) {}
+        while (fc.cols > 1 && robot_free(column(fc.cols - 1)) && attempt(crop(0, 0, fc.rows, fc.cols - 1))) {}
+        while (fc.cols > 1 && robot_free(column(0)) && attempt(crop(0, 1, fc.rows, fc.cols - 1))) {}
+    }
+    return fc;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    long long cases = 1000;
+    unsigned seed = 1;
+    std::string replay;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) cases = std::stoll(argv[++i]);
+        else if (arg == "-s" && i + 1 < argc) seed = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if (arg == "--replay" && i + 1 < argc) replay = argv[++i];
+        else {
+            std::cerr << "Usage: " << argv[0] << " [-n cases] [-s seed] [--replay CASE]\n";
+            return 1;
+        }
+    }
+
+    if (!replay.empty()) {
+        auto fc = parse_case(replay);
+        if (!fc) {
+            std::cerr << "Cannot parse case: " << replay << "\n";
+            return 1;
+        }
+        auto div = run_case(*fc);
+        if (!div) {
+            std::cout << "engines agree\n";
+            return 0;
+        }
+        std::cout << "round " << div->round << ": " << div->what << "\n";
+        return 1;
+    }
+
+    std::mt19937 rng(seed);
+    for (long long n = 1; n <= cases; ++n) {
+        FuzzCase fc = random_case(rng);
+        auto div = run_case(fc);
+        if (div) {
+            std::cout << "case " << n << " diverged in round " << div->round << ": " << div->what << "\n"
+                      << "  " << to_string(fc) << "\nshrinking...\n";
+            Divergence minimal = *div;
+            FuzzCase small = shrink(fc, minimal);
+            std::cout << "round " << minimal.round << ": " << minimal.what << "\n"
+                      << "reproduce with:\n  engine_fuzz --replay \"" << to_string(small) << "\"\n";
+            return 1;
+        }
+        if (n % 100 == 0) std::cout << n << " cases (" << g_turns << " turns), engines agree\n" << std::flush;
+    }
+    std::cout << cases << " cases, " << g_turns << " turns compared, no divergence\n";
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// Runs a fork-mode tournament with a robot that never returns from its first
+// call and checks the batch deadline deals with it:
+//   the run finishes, well before it would if nothing killed the workers
+//   every match the hung robot is in is given up, and only those: each
+//   killed worker loses the match it was playing and queues the rest again
+//
+// usage: fork_check
+// Run from the build directory after make: it runs ./tournament on copies of
+// the robots here plus the hanging one. Robot_Flame_e_o seeds std::rand from
+// the clock and is left out, as in resume_check.
+
+namespace {
+
+namespace fs = std::filesystem;
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "  ok    " : "  FAIL  ") << what << "\n";
+    if (!ok) ++failures;
+}
+
+const char* hang_robot = R"(#include "RobotBase.h"
+
+class Robot_Hang : public RobotBase {
+public:
+    Robot_Hang() : RobotBase(3, 4, railgun) { m_name = "Hang"; }
+    void get_radar_direction(int& d) override { volatile unsigned spin = 0; for (;;) ++spin; d = 0; }
+    void process_radar_results(const std::vector<RadarObj>&) override {}
+    bool get_shot_location(int&, int&) override { return false; }
+    void get_move_direction(int& d, int& s) override { d = 1; s = 0; }
+};
+
+extern "C" RobotBase* create_robot() { return new Robot_Hang(); }
+)";
+
+size_t count_of(const std::string& text, const std::string& what) {
+    size_t n = 0;
+    for (size_t at = text.find(what); at != std::string::npos; at = text.find(what, at + 1)) ++n;
+    return n;
+}
+
+} // namespace
+
+int main() {
+    fs::path dir = fs::temp_directory_path() / ("robotwarz-fork-check-" + std::to_string(getpid()));
+    fs::create_directories(dir / "robots");
+    for (const auto& p : fs::directory_iterator(".")) {
+        std::string name = p.path().filename().string();
+        if (name.rfind("Robot_", 0) != 0 || p.path().extension() != ".cpp" || name == "Robot_Flame_e_o.cpp") continue;
+        fs::copy_file(p.path(), dir / "robots" / name);
+    }
+    std::ofstream(dir / "robots" / "Robot_Hang.cpp") << hang_robot;
+
+    const int matches = 40;
+    fs::path log = dir / "fork.log";
+    std::cout << "deadline, " << matches << " matches\n";
+    auto t0 = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        int fd = ::open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0) {
+            dup2(fd, 1);
+            dup2(fd, 2);
+            ::close(fd);
+        }
+        std::string n = std::to_string(matches), robots = (dir / "robots").string();
+        execl("./tournament", "./tournament", "-n", n.c_str(), "-s", "5", "-t", "2", "-f", "5", "-D", "0.2",
+              "-q", "20", "--uniform", robots.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+
+    // Without the deadline the run never ends; give it far longer than it needs
+    int status = 0;
+    bool exited = false;
+    while (std::chrono::steady_clock::now() - t0 < std::chrono::seconds(120)) {
+        if (waitpid(pid, &status, WNOHANG) == pid) { exited = true; break; }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    if (!exited) {
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+    }
+    check(exited && WIFEXITED(status) && WEXITSTATUS(status) == 0, "the run finishes");
+
+    std::ifstream in(log);
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    size_t killed = count_of(text, "ran past its deadline and was killed");
+    check(killed > 0, std::to_string(killed) + " workers were killed at their deadline");
+    check(count_of(text, ", 1 of its matches lost") == killed, "each killed worker lost exactly one match");
+
+    std::string summary = std::to_string(matches - static_cast<int>(killed)) + " matches in ";
+    check(text.find(summary) != std::string::npos, "every other match was played: " + summary.substr(0, summary.size() - 4));
+    size_t row = text.find("\nHang ");
+    std::string hangRow = row == std::string::npos ? "" : text.substr(row + 1, text.find('\n', row + 1) - row - 1);
+    check(hangRow.size() > 8 && hangRow.compare(hangRow.size() - 8, 8, " 0 games") == 0,
+          "no match with the hung robot produced a result");
+
+    fs::remove_all(dir);
+    if (failures) {
+        std::cout << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "all fork checks passed\n";
+    return 0;
+}
@@ -0,0 +1,192 @@
+#include "RobotHeap.h"
+#include "RobotLibraryPool.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <new>
+#include <unistd.h>
+
+// Checks RobotHeap the way the arena uses it across matches:
+//   reuse    a heap dropped with nothing left in it hands its chunks to the
+//            next match's heap on the same thread
+//   static   a robot whose function-local static container was filled in
+//            its heap keeps that container intact after the instance and
+//            heap are dropped, while later heaps allocate and scribble; the
+//            retired heap goes away once dlclose runs the static destructors
+//   handler  an allocation over the heap's limit runs the new_handler and
+//            succeeds once the handler makes room
+//
+// usage: heap_check
+// Run from the build directory: the static check compiles a robot against
+// RobotBase.o and the helper objects like the arena does.
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "  ok    " : "  FAIL  ") << what << "\n";
+    if (!ok) ++failures;
+}
+
+void check_reuse() {
+    std::cout << "reuse\n";
+    auto first = RobotHeap::make();
+    char* block = nullptr;
+    {
+        RobotHeap::Scope scope(first.get());
+        block = new char[100];
+        std::memset(block, 1, 100);
+        delete[] block;
+    }
+    first.reset();
+
+    auto second = RobotHeap::make();
+    char* again = nullptr;
+    {
+        RobotHeap::Scope scope(second.get());
+        again = new char[100];
+    }
+    check(again == block, "the next match's first block reuses the dropped heap's chunk");
+    {
+        RobotHeap::Scope scope(second.get());
+        delete[] again;
+    }
+    check(second->release(), "a heap with every block freed releases");
+}
+
+// Keeps what it scans in a function-local static, like Robot_Oracle_Tune's
+// state, and reports the sum of all of it as its move distance
+const char* static_robot = R"(#include "RobotBase.h"
+#include <vector>
+
+static std::vector<int>& seen() {
+    static std::vector<int> all;
+    return all;
+}
+
+class Robot_HeapCheck : public RobotBase {
+public:
+    Robot_HeapCheck() : RobotBase(2, 3, railgun) {}
+    void get_radar_direction(int& dir) override { dir = 0; }
+    void process_radar_results(const std::vector<RadarObj>& objs) override {
+        for (int i = 0; i < 1000; ++i) seen().push_back(static_cast<int>(objs.size()) + i);
+    }
+    bool get_shot_location(int&, int&) override { return false; }
+    void get_move_direction(int& dir, int& dist) override {
+        long long sum = 0;
+        for (int v : seen()) sum += v;
+        dir = 0;
+        dist = static_cast<int>(sum);
+    }
+};
+
+extern "C" RobotBase* create_robot() { return new Robot_HeapCheck; }
+)";
+
+void check_static() {
+    std::cout << "static\n";
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / ("robotwarz-heap-check-" + std::to_string(getpid()));
+    fs::create_directories(dir);
+    fs::path source = dir / "Robot_HeapCheck.cpp";
+    std::ofstream(source) << static_robot;
+
+    size_t retiredBefore = RobotHeap::retired_count();
+    {
+        RobotLibraryPool pool;
+        bool loaded = pool.load_source(source.string());
+        check(loaded, "the robot compiles and loads");
+        if (!loaded) { fs::remove_all(dir); return; }
+        RobotFactory factory = pool.factories().front().factory;
+
+        auto heap = RobotHeap::make();
+        {
+            std::unique_ptr<RobotBase> robot;
+            RobotHeap::Scope scope(heap.get());
+            robot.reset(factory());
+            robot->process_radar_results({});
+        }
+        check(!heap->release(), "the heap does not release while the static holds blocks in it");
+        heap.reset();
+        check(RobotHeap::retired_count() == retiredBefore + 1, "the dropped heap is retired");
+
+        // Later matches allocate and overwrite whatever memory they get
+        for (int match = 0; match < 4; ++match) {
+            auto other = RobotHeap::make();
+            RobotHeap::Scope scope(other.get());
+            std::vector<std::vector<unsigned char>> junk;
+            for (int i = 0; i < 64; ++i) junk.emplace_back(512 + i * 64, 0xAB);
+        }
+
+        auto heap2 = RobotHeap::make();
+        int dir = 0, dist = 0;
+        {
+            RobotHeap::Scope scope(heap2.get());
+            std::unique_ptr<RobotBase> robot(factory());
+            robot->get_move_direction(dir, dist);
+        }
+        check(dist == 499500, "the static's contents survive later matches (sum " + std::to_string(dist) + ")");
+    }
+    // the pool closed the library and its static destructor freed the vector
+    check(RobotHeap::retired_count() == retiredBefore, "the retired heap went away at dlclose");
+    fs::remove_all(dir);
+    std::filesystem::remove("./libRobot_HeapCheck.so");
+    std::filesystem::remove("./libRobot_HeapCheck.so.stamp");
+}
+
+RobotHeap* handler_heap = nullptr;
+int handler_calls = 0;
+
+void check_new_handler() {
+    std::cout << "handler\n";
+    auto heap = RobotHeap::make();
+    heap->set_limit(1024);
+    handler_heap = heap.get();
+    std::set_new_handler([] {
+        ++handler_calls;
+        handler_heap->set_limit(0);
+    });
+
+    char* p = nullptr;
+    {
+        RobotHeap::Scope scope(heap.get());
+        try {
+            p = new char[4096];
+        } catch (const std::bad_alloc&) {
+        }
+    }
+    std::set_new_handler(nullptr);
+    check(p != nullptr && handler_calls == 1, "the new_handler ran once and the allocation then succeeded");
+
+    heap->set_limit(1024);
+    bool threw = false;
+    {
+        RobotHeap::Scope scope(heap.get());
+        delete[] p;
+        try {
+            p = new char[4096];
+        } catch (const std::bad_alloc&) {
+            threw = true;
+        }
+    }
+    check(threw, "without a new_handler an allocation over the limit throws std::bad_alloc");
+}
+
+} // namespace
+
+int main() {
+    check_reuse();
+    check_static();
+    check_new_handler();
+    if (failures) {
+        std::cout << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "all heap checks passed\n";
+    return 0;
+}
@@ -0,0 +1,37 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#include "GameMap.h"
+
+// Converts between the ASCII board robotwarz prints and binary .rwm maps.
+//
+// usage: map_convert board.txt map.rwm    ASCII (PlayingBoard::render) to binary
+//        map_convert --print map.rwm      binary back to ASCII, spawns as 'R'
+// In the ASCII form 'M', 'F' and 'P' are obstacles and 'R' marks a spawn point.
+int main(int argc, char* argv[]) {
+    if (argc == 3 && std::string(argv[1]) == "--print") {
+        auto map = GameMap::load(argv[2]);
+        if (!map) return 1;
+        PlayingBoard board = map->board();
+        for (const auto& [r, c] : map->spawns()) board.place_robot(r, c, 0);
+        std::cout << board.render();
+        std::cerr << map->rows() << "x" << map->cols() << ", " << map->spawns().size() << " spawn points\n";
+        return 0;
+    }
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " board.txt map.rwm | --print map.rwm\n";
+        return 1;
+    }
+
+    std::ifstream in(argv[1]);
+    if (!in) {
+        std::cerr << "Cannot open " << argv[1] << "\n";
+        return 1;
+    }
+    auto map = GameMap::parse_ascii(in);
+    if (!map || !map->save(argv[2])) return 1;
+    std::cout << argv[2] << ": " << map->rows() << "x" << map->cols() << ", "
+              << map->spawns().size() << " spawn points\n";
+    return 0;
+}
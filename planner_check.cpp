@@ -0,0 +1,279 @@
+#include "PathPlanner.h"
+#include "ThreadCpuClock.h"
+#include "RobotBase.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+// Checks PathPlanner while chasing a target that moves every turn, the way
+// Robot_Flame_e_o uses it:
+//   correctness  each answer is checked against a plain BFS from the target:
+//                the distance matches, and the step walks cells each one
+//                closer to the target (or there is no path and no step)
+//   cost         per query, cells expanded and thread CPU time stay small on
+//                a 1000x1000 board: a query must fit the conformance budget
+//                and expand a bounded number of cells per step of distance
+//   fixed goal   walking to a goal that does not move reuses its field
+// Obstacles keep appearing during the chase, so cached fields are repaired
+// or rebuilt along the way.
+//
+// usage: planner_check [-s seed]
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "  ok    " : "  FAIL  ") << what << "\n";
+    if (!ok) ++failures;
+}
+
+// Steps from every cell to the target, -1 where it cannot be reached
+std::vector<int> reference_bfs(const OccupancyMap& map, int target) {
+    int rows = map.rows(), cols = map.cols();
+    std::vector<int> dist(static_cast<size_t>(rows) * cols, -1);
+    std::vector<int> queue{target};
+    dist[target] = 0;
+    for (size_t head = 0; head < queue.size(); ++head) {
+        int u = queue[head];
+        int r = u / cols, c = u % cols;
+        for (int d = 1; d <= 8; ++d) {
+            int nr = r + directions[d].first, nc = c + directions[d].second;
+            if (!map.in_bounds(nr, nc) || map.obstacle(nr, nc)) continue;
+            int n = nr * cols + nc;
+            if (dist[n] != -1) continue;
+            dist[n] = dist[u] + 1;
+            queue.push_back(n);
+        }
+    }
+    return dist;
+}
+
+// The planner's answer from (row, col) must agree with the BFS: the robot's
+// own cell may be an obstacle, so its distance comes from its neighbors
+bool step_is_shortest(const OccupancyMap& map, const std::vector<int>& ref, int row, int col,
+                      const PathPlanner::Step& step, std::string& why) {
+    int cols = map.cols();
+    int expected = -1;
+    if (ref[row * cols + col] == 0) {
+        expected = 0;
+    } else {
+        for (int d = 1; d <= 8; ++d) {
+            int nr = row + directions[d].first, nc = col + directions[d].second;
+            if (!map.in_bounds(nr, nc)) continue;
+            int nd = ref[nr * cols + nc];
+            if (nd >= 0 && (expected < 0 || nd + 1 < expected)) expected = nd + 1;
+        }
+    }
+    if (step.remaining != expected) {
+        why = "remaining " + std::to_string(step.remaining) + ", BFS says " + std::to_string(expected);
+        return false;
+    }
+    if (expected <= 0) {
+        if (step.direction != 0) { why = "a step where none is needed or possible"; return false; }
+        return true;
+    }
+    if (step.direction < 1 || step.direction > 8 || step.distance < 1) {
+        why = "no step toward a reachable target";
+        return false;
+    }
+    int r = row, c = col, left = expected;
+    for (int s = 0; s < step.distance; ++s) {
+        r += directions[step.direction].first;
+        c += directions[step.direction].second;
+        if (!map.in_bounds(r, c) || ref[r * cols + c] != left - 1) {
+            why = "step " + std::to_string(s + 1) + " of " + std::to_string(step.distance) + " leaves the shortest path";
+            return false;
+        }
+        --left;
+    }
+    return true;
+}
+
+int random_open_cell(const OccupancyMap& map, std::mt19937& rng) {
+    std::uniform_int_distribution<int> row(0, map.rows() - 1), col(0, map.cols() - 1);
+    for (;;) {
+        int r = row(rng), c = col(rng);
+        if (!map.obstacle(r, c)) return r * map.cols() + c;
+    }
+}
+
+void scatter_mounds(OccupancyMap& map, std::mt19937& rng, double density) {
+    std::bernoulli_distribution mound(density);
+    for (int r = 0; r < map.rows(); ++r)
+        for (int c = 0; c < map.cols(); ++c)
+            if (mound(rng)) map.mark(r, c, 'M');
+}
+
+// Walls with a gap, so paths have to go around rather than straight
+void build_walls(OccupancyMap& map, std::mt19937& rng, int count) {
+    std::uniform_int_distribution<int> row(0, map.rows() - 1), col(0, map.cols() - 1);
+    for (int w = 0; w < count; ++w) {
+        int r = row(rng), c = col(rng);
+        int length = map.rows() / 3;
+        bool vertical = rng() & 1;
+        for (int i = 0; i < length; ++i) {
+            if (i == length / 2) continue;
+            int wr = vertical ? r + i : r, wc = vertical ? c : c + i;
+            if (map.in_bounds(wr, wc)) map.mark(wr, wc, 'M');
+        }
+    }
+}
+
+struct Chase {
+    long long queries = 0;
+    long long checked = 0;
+    long long wrong = 0;
+    long long worstNs = 0;
+    long long totalNs = 0;
+    uint64_t expanded = 0;
+    double worstPerStep = 0;   // cells expanded per step of distance, worst query
+    std::string firstWrong;
+};
+
+// The target takes a random step or two every turn and the robot follows the
+// planner at speed 2; every checkEvery-th query is compared with a full BFS
+Chase chase(OccupancyMap& map, std::mt19937& rng, int turns, int checkEvery, double newMounds) {
+    PathPlanner planner(map, 4, 0);
+    Chase out;
+    int cols = map.cols();
+    int robot = random_open_cell(map, rng);
+    int target = random_open_cell(map, rng);
+    std::bernoulli_distribution reveal(newMounds);
+
+    for (int turn = 0; turn < turns; ++turn) {
+        for (int moves = 1 + static_cast<int>(rng() % 2); moves > 0; --moves) {
+            int d = 1 + static_cast<int>(rng() % 8);
+            int nr = target / cols + directions[d].first, nc = target % cols + directions[d].second;
+            if (map.in_bounds(nr, nc) && !map.obstacle(nr, nc)) target = nr * cols + nc;
+        }
+        // now and then a mound turns up somewhere, as the radar would report it
+        if (reveal(rng)) {
+            int m = random_open_cell(map, rng);
+            if (m != target && m != robot) map.mark(m / cols, m % cols, 'M');
+        }
+
+        int row = robot / cols, col = robot % cols;
+        uint64_t before = planner.expanded();
+        long long t0 = ThreadCpuClock::now_ns();
+        PathPlanner::Step step = planner.toward(row, col, target / cols, target % cols, 2);
+        long long ns = ThreadCpuClock::now_ns() - t0;
+        uint64_t cells = planner.expanded() - before;
+
+        ++out.queries;
+        out.totalNs += ns;
+        out.worstNs = std::max(out.worstNs, ns);
+        out.expanded += cells;
+        if (step.remaining > 0) {
+            out.worstPerStep = std::max(out.worstPerStep, static_cast<double>(cells) / step.remaining);
+        }
+
+        if (turn % checkEvery == 0) {
+            ++out.checked;
+            std::string why;
+            if (!step_is_shortest(map, reference_bfs(map, target), row, col, step, why)) {
+                if (out.wrong++ == 0) out.firstWrong = "turn " + std::to_string(turn) + ": " + why;
+            }
+        }
+
+        for (int s = 0; s < step.distance; ++s) {
+            row += directions[step.direction].first;
+            col += directions[step.direction].second;
+        }
+        robot = row * cols + col;
+        if (robot == target || step.remaining < 0) {
+            robot = random_open_cell(map, rng);
+        }
+    }
+    return out;
+}
+
+void report(const Chase& c) {
+    std::cout << "  " << c.queries << " queries: " << std::fixed << std::setprecision(1)
+              << c.totalNs / 1000.0 / c.queries << " us avg, " << c.worstNs / 1000.0 << " us worst, "
+              << static_cast<double>(c.expanded) / c.queries << " cells expanded avg, "
+              << c.worstPerStep << " per step of distance worst\n";
+}
+
+void check_correctness(std::mt19937& rng) {
+    std::cout << "correctness, 200x200 with mounds and walls\n";
+    OccupancyMap map(200, 200);
+    scatter_mounds(map, rng, 0.12);
+    build_walls(map, rng, 12);
+    Chase c = chase(map, rng, 3000, 1, 0.2);
+    report(c);
+    check(c.wrong == 0, std::to_string(c.checked) + " answers match a full BFS" +
+                        (c.wrong ? " (" + std::to_string(c.wrong) + " wrong, first at " + c.firstWrong + ")" : ""));
+}
+
+void check_cost(std::mt19937& rng) {
+    std::cout << "cost, 1000x1000 with sparse mounds\n";
+    OccupancyMap map(1000, 1000);
+    scatter_mounds(map, rng, 0.02);
+    Chase c = chase(map, rng, 400, 20, 0.05);
+    report(c);
+    check(c.wrong == 0, std::to_string(c.checked) + " sampled answers match a full BFS" +
+                        (c.wrong ? " (first wrong at " + c.firstWrong + ")" : ""));
+    check(c.worstNs < 1000 * 1000, "every query fits the 1 ms conformance budget");
+    check(c.worstPerStep <= 64, "no query expands more than 64 cells per step of distance");
+}
+
+// A goal that stays put: the first query pays for the search, the walk there
+// only reads the field
+void check_fixed_goal(std::mt19937& rng) {
+    std::cout << "fixed goal, 1000x1000 with sparse mounds\n";
+    OccupancyMap map(1000, 1000);
+    scatter_mounds(map, rng, 0.02);
+    PathPlanner planner(map, 4, 0);
+    int cols = map.cols();
+    int robot = random_open_cell(map, rng), goal = random_open_cell(map, rng);
+    int row = robot / cols, col = robot % cols;
+
+    PathPlanner::Step step = planner.toward(row, col, goal / cols, goal % cols, 2);
+    uint64_t first = planner.expanded();
+    int walked = 0;
+    bool onPath = true;
+    auto ref = reference_bfs(map, goal);
+    while (step.direction != 0) {
+        std::string why;
+        if (!step_is_shortest(map, ref, row, col, step, why)) { onPath = false; break; }
+        row += directions[step.direction].first * step.distance;
+        col += directions[step.direction].second * step.distance;
+        walked += step.distance;
+        step = planner.toward(row, col, goal / cols, goal % cols, 2);
+    }
+    uint64_t walk = planner.expanded() - first;
+    std::cout << "  " << walked << " steps: first query expanded " << first << " cells, the walk " << walk << "\n";
+    check(onPath && row * cols + col == goal, "the walk follows shortest steps to the goal");
+    check(walk <= first, "walking there expands no more than the first query did");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-s" && i + 1 < argc) seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        else {
+            std::cerr << "Usage: " << argv[0] << " [-s seed]\n";
+            return 2;
+        }
+    }
+
+    std::mt19937 rng(seed);
+    check_correctness(rng);
+    check_cost(rng);
+    check_fixed_goal(rng);
+    if (failures) {
+        std::cout << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "all planner checks passed\n";
+    return 0;
+}
@@ -0,0 +1,272 @@
+#include "ResultsStore.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <charconv>
+#include <cstring>
+
+// Query tool for the results files written by `tournament -o`. The file is
+// mapped and every report is a pass over whole columns, so the inner loops
+// are plain array scans the compiler can keep in registers (and vectorize
+// where the work allows it).
+//
+// usage: results_query [--config HASH] results.rwc [winrates] [h2h] [percentiles]
+// Without a report name all three are printed. --config keeps only matches
+// played with that config_hash (as printed by winrates).
+
+namespace {
+
+struct Selection {
+    bool filtered = false;
+    uint64_t configHash = 0;
+    // per block, 1 for each match that passes the filter
+    std::vector<std::vector<uint8_t>> matchKeep;
+    // per block, the same expanded to one flag per robot entry
+    std::vector<std::vector<uint8_t>> entryKeep;
+    size_t matches = 0;
+};
+
+Selection select(const results::Reader& in, bool filtered, uint64_t configHash) {
+    Selection sel;
+    sel.filtered = filtered;
+    sel.configHash = configHash;
+    for (const auto& b : in.blocks()) {
+        std::vector<uint8_t> keep(b.matches), entries(b.entries);
+        for (size_t m = 0; m < b.matches; ++m) keep[m] = !filtered || b.configHash[m] == configHash;
+        size_t e = 0;
+        for (size_t m = 0; m < b.matches; ++m) {
+            std::fill_n(entries.begin() + e, b.entryCount[m], keep[m]);
+            e += b.entryCount[m];
+        }
+        for (size_t m = 0; m < b.matches; ++m) sel.matches += keep[m];
+        sel.matchKeep.push_back(std::move(keep));
+        sel.entryKeep.push_back(std::move(entries));
+    }
+    return sel;
+}
+
+void win_rates(const results::Reader& in, const Selection& sel) {
+    size_t robots = in.names().size();
+    std::vector<uint64_t> games(robots), wins(robots), placeSum(robots);
+    std::vector<int64_t> dealt(robots), taken(robots);
+    std::vector<uint64_t> configs;
+
+    for (size_t bi = 0; bi < in.blocks().size(); ++bi) {
+        const auto& b = in.blocks()[bi];
+        const auto& keepM = sel.matchKeep[bi];
+        const auto& keepE = sel.entryKeep[bi];
+
+        for (size_t m = 0; m < b.matches; ++m) {
+            if (keepM[m] && b.winner[m] >= 0) ++wins[b.winner[m]];
+        }
+        for (size_t e = 0; e < b.entries; ++e) {
+            uint32_t r = b.robot[e];
+            uint64_t k = keepE[e];
+            games[r] += k;
+            placeSum[r] += k * b.place[e];
+            dealt[r] += static_cast<int64_t>(k) * b.damageDealt[e];
+            taken[r] += static_cast<int64_t>(k) * b.damageTaken[e];
+        }
+        if (!sel.filtered) {
+            for (size_t m = 0; m < b.matches; ++m) {
+                if (configs.size() < 16 && std::find(configs.begin(), configs.end(), b.configHash[m]) == configs.end()) {
+                    configs.push_back(b.configHash[m]);
+                }
+            }
+        }
+    }
+
+    std::vector<size_t> order;
+    for (size_t r = 0; r < robots; ++r) if (games[r]) order.push_back(r);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return wins[a] * games[b] > wins[b] * games[a];
+    });
+
+    std::cout << "\nWin rates over " << sel.matches << " matches\n";
+    std::cout << std::left << std::setw(20) << "robot" << std::right << std::setw(10) << "games"
+              << std::setw(10) << "wins" << std::setw(8) << "win%" << std::setw(8) << "place"
+              << std::setw(10) << "dealt" << std::setw(10) << "taken" << "\n";
+    for (size_t r : order) {
+        double g = static_cast<double>(games[r]);
+        std::cout << std::left << std::setw(20) << in.names()[r] << std::right
+                  << std::setw(10) << games[r] << std::setw(10) << wins[r]
+                  << std::fixed << std::setprecision(1) << std::setw(8) << 100.0 * wins[r] / g
+                  << std::setprecision(2) << std::setw(8) << placeSum[r] / g
+                  << std::setprecision(1) << std::setw(10) << dealt[r] / g
+                  << std::setw(10) << taken[r] / g << "\n";
+    }
+    if (configs.size() > 1) {
+        std::cout << "configs (use --config to pick one):";
+        for (uint64_t c : configs) std::cout << " 0x" << std::hex << c << std::dec;
+        std::cout << (configs.size() == 16 ? " ..." : "") << "\n";
+    }
+}
+
+// Row robot vs column robot: share of the matches they both played where the
+// row robot placed better; equal places count half
+void head_to_head(const results::Reader& in, const Selection& sel) {
+    size_t robots = in.names().size();
+    std::vector<double> score(robots * robots, 0.0);
+    std::vector<uint64_t> met(robots * robots, 0);
+
+    for (size_t bi = 0; bi < in.blocks().size(); ++bi) {
+        const auto& b = in.blocks()[bi];
+        const auto& keepM = sel.matchKeep[bi];
+        size_t first = 0;
+        for (size_t m = 0; m < b.matches; first += b.entryCount[m], ++m) {
+            if (!keepM[m]) continue;
+            size_t last = first + b.entryCount[m];
+            for (size_t i = first; i < last; ++i) {
+                for (size_t j = first; j < last; ++j) {
+                    uint32_t a = b.robot[i], c = b.robot[j];
+                    if (i == j || a == c) continue;
+                    size_t cell = a * robots + c;
+                    ++met[cell];
+                    score[cell] += b.place[i] < b.place[j] ? 1.0 : b.place[i] == b.place[j] ? 0.5 : 0.0;
+                }
+            }
+        }
+    }
+
+    std::vector<size_t> shown;
+    for (size_t r = 0; r < robots; ++r) {
+        for (size_t c = 0; c < robots; ++c) {
+            if (met[r * robots + c]) { shown.push_back(r); break; }
+        }
+    }
+
+    std::cout << "\nHead to head (row beats column, %)\n" << std::setw(20) << "";
+    for (size_t c : shown) std::cout << std::setw(8) << in.names()[c].substr(0, 7);
+    std::cout << "\n";
+    for (size_t r : shown) {
+        std::cout << std::left << std::setw(20) << in.names()[r] << std::right;
+        for (size_t c : shown) {
+            size_t cell = r * robots + c;
+            if (met[cell]) std::cout << std::fixed << std::setprecision(1) << std::setw(8) << 100.0 * score[cell] / met[cell];
+            else std::cout << std::setw(8) << "-";
+        }
+        std::cout << "\n";
+    }
+}
+
+// p50/p90/p99 of values, which is reordered
+void print_percentiles(std::vector<uint32_t>& values) {
+    for (double q : {0.5, 0.9, 0.99}) {
+        if (values.empty()) { std::cout << std::setw(10) << "-"; continue; }
+        auto at = values.begin() + static_cast<size_t>(q * (values.size() - 1));
+        std::nth_element(values.begin(), at, values.end());
+        std::cout << std::setw(10) << *at;
+    }
+}
+
+template <typename Column>
+void robot_percentiles(const results::Reader& in, const Selection& sel, const char* title, Column column) {
+    size_t robots = in.names().size();
+    std::vector<std::vector<uint32_t>> values(robots);
+    for (size_t bi = 0; bi < in.blocks().size(); ++bi) {
+        const auto& b = in.blocks()[bi];
+        const auto& keepE = sel.entryKeep[bi];
+        const auto* col = column(b);
+        for (size_t e = 0; e < b.entries; ++e) {
+            if (keepE[e]) values[b.robot[e]].push_back(static_cast<uint32_t>(std::max<int64_t>(0, col[e])));
+        }
+    }
+
+    std::cout << "\n" << std::left << std::setw(20) << title << std::right
+              << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99" << "\n";
+    for (size_t r = 0; r < robots; ++r) {
+        if (values[r].empty()) continue;
+        std::cout << std::left << std::setw(20) << in.names()[r] << std::right;
+        print_percentiles(values[r]);
+        std::cout << "\n";
+        std::vector<uint32_t>().swap(values[r]);
+    }
+}
+
+void percentiles(const results::Reader& in, const Selection& sel) {
+    std::vector<uint32_t> rounds;
+    rounds.reserve(sel.matches);
+    for (size_t bi = 0; bi < in.blocks().size(); ++bi) {
+        const auto& b = in.blocks()[bi];
+        const auto& keepM = sel.matchKeep[bi];
+        for (size_t m = 0; m < b.matches; ++m) {
+            if (keepM[m]) rounds.push_back(b.rounds[m]);
+        }
+    }
+    std::cout << "\n" << std::left << std::setw(20) << "rounds" << std::right
+              << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99" << "\n"
+              << std::setw(20) << "";
+    print_percentiles(rounds);
+    std::cout << "\n";
+
+    robot_percentiles(in, sel, "damage dealt", [](const results::Block& b) { return b.damageDealt; });
+    robot_percentiles(in, sel, "damage taken", [](const results::Block& b) { return b.damageTaken; });
+    robot_percentiles(in, sel, "cpu us", [](const results::Block& b) { return b.cpuUs; });
+    robot_percentiles(in, sel, "heap peak kb", [](const results::Block& b) { return b.heapKb; });
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string path;
+    std::vector<std::string> reports;
+    bool filtered = false;
+    uint64_t configHash = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--config" && i + 1 < argc) {
+            // hex with 0x as winrates prints it, else decimal; anything else is a usage error
+            const char* text = argv[++i];
+            const char* end = text + std::strlen(text);
+            int base = 10;
+            if (end - text > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+                text += 2;
+                base = 16;
+            }
+            auto [stop, ec] = std::from_chars(text, end, configHash, base);
+            if (ec != std::errc() || stop != end) {
+                path.clear();
+                break;
+            }
+            filtered = true;
+        } else if (arg == "winrates" || arg == "h2h" || arg == "percentiles") {
+            reports.push_back(arg);
+        } else if (arg.rfind("-", 0) != 0 && path.empty()) {
+            path = arg;
+        } else {
+            path.clear();
+            break;
+        }
+    }
+    if (path.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--config HASH] results.rwc [winrates] [h2h] [percentiles]\n";
+        return 1;
+    }
+    if (reports.empty()) reports = {"winrates", "h2h", "percentiles"};
+
+    auto t0 = std::chrono::steady_clock::now();
+    results::Reader in(path);
+    if (!in.ok() || in.matches() == 0) {
+        std::cerr << "No results in " << path << "\n";
+        return 1;
+    }
+    Selection sel = select(in, filtered, configHash);
+    std::cout << path << ": " << in.matches() << " matches, " << in.names().size() << " robots";
+    if (filtered) std::cout << ", " << sel.matches << " with config 0x" << std::hex << configHash << std::dec;
+    std::cout << "\n";
+
+    for (const auto& r : reports) {
+        if (r == "winrates") win_rates(in, sel);
+        else if (r == "h2h") head_to_head(in, sel);
+        else percentiles(in, sel);
+    }
+
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "\n(" << std::fixed << std::setprecision(2) << secs << "s)\n";
+    return 0;
+}
@@ -0,0 +1,204 @@
+#include "ResultsStore.h"
+#include "Checkpoint.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// Kills a checkpointed tournament partway through, resumes it, and checks
+// that the resumed run recorded exactly the matches an uninterrupted one
+// does, each once:
+//   thread   tournament -t 2, SIGKILLed once it has written its first block
+//            of results (4096 matches) and before it finishes, so the resume
+//            has to trim results the checkpoint does not vouch for
+//   fork     the same with -f, the matches played in forked workers
+//   lost     the thread run again, but before resuming the checkpoint is made
+//            to vouch for the whole results file and the file is then cut
+//            in half, as if the machine went down before the file was
+//            synced; the resume has to rewrite the matches it lost
+// Pairings are --uniform, so a match depends only on its number and the
+// results are compared match by match, whatever order they were written in.
+//
+// usage: resume_check [-n matches]
+// Run from the build directory after make: it runs ./tournament on copies of
+// the robots here. Robot_Flame_e_o seeds std::rand from the clock, so its
+// matches cannot be replayed and it is left out.
+
+namespace {
+
+namespace fs = std::filesystem;
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "  ok    " : "  FAIL  ") << what << "\n";
+    if (!ok) ++failures;
+}
+
+// Starts ./tournament with args, its output going to log
+pid_t start(const std::vector<std::string>& args, const fs::path& log) {
+    pid_t pid = fork();
+    if (pid != 0) return pid;
+    int fd = ::open(log.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd >= 0) {
+        dup2(fd, 1);
+        dup2(fd, 2);
+        ::close(fd);
+    }
+    std::vector<char*> argv{const_cast<char*>("./tournament")};
+    for (const auto& a : args) argv.push_back(const_cast<char*>(a.c_str()));
+    argv.push_back(nullptr);
+    execv("./tournament", argv.data());
+    _exit(127);
+}
+
+bool finish(pid_t pid) {
+    int status = 0;
+    return waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+uintmax_t size_of(const fs::path& path) {
+    std::error_code ec;
+    uintmax_t n = fs::file_size(path, ec);
+    return ec ? 0 : n;
+}
+
+// One line per match with everything that does not depend on timing, sorted
+std::vector<std::string> matches_in(const fs::path& path) {
+    results::Reader in(path.string());
+    std::vector<std::string> out;
+    for (const auto& b : in.blocks()) {
+        size_t e = 0;
+        for (size_t m = 0; m < b.matches; ++m) {
+            std::string line = std::to_string(b.seed[m]) + " " + std::to_string(b.configHash[m]) + " " +
+                               std::to_string(b.rounds[m]) + " " +
+                               (b.winner[m] >= 0 ? in.names()[b.winner[m]] : std::string("-"));
+            for (uint32_t k = 0; k < b.entryCount[m]; ++k, ++e) {
+                line += " " + in.names()[b.robot[e]] + ":" + std::to_string(b.place[e]) + ":" +
+                        std::to_string(b.damageDealt[e]) + ":" + std::to_string(b.damageTaken[e]);
+            }
+            out.push_back(std::move(line));
+        }
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+// Appends a results record saying the results file held resultsBytes, the
+// way TournamentCheckpoint::mark_results does
+bool vouch_for(const fs::path& ckpt, uint64_t resultsBytes) {
+    unsigned char payload[sizeof(resultsBytes)];
+    std::memcpy(payload, &resultsBytes, sizeof(payload));
+    uint32_t sum = 2166136261u; // FNV-1a, as the checkpoint checks it
+    for (unsigned char b : payload) sum = (sum ^ b) * 16777619u;
+    TournamentCheckpoint::RecordHeader h{TournamentCheckpoint::record_magic, TournamentCheckpoint::results_record,
+                                         sizeof(payload), sum};
+    std::ofstream out(ckpt, std::ios::binary | std::ios::app);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char*>(payload), sizeof(payload));
+    return static_cast<bool>(out);
+}
+
+std::string read_text(const fs::path& path) {
+    std::ifstream in(path);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+void check_mode(const char* title, const std::vector<std::string>& modeArgs, const std::vector<std::string>& common,
+                const fs::path& dir, const std::vector<std::string>& reference, bool loseResults = false) {
+    std::cout << title << "\n";
+    fs::path ckpt = dir / (std::string(title) + ".ckpt");
+    fs::path rwc = dir / (std::string(title) + ".rwc");
+    fs::path log = dir / (std::string(title) + ".log");
+    std::vector<std::string> args = common;
+    args.insert(args.end(), modeArgs.begin(), modeArgs.end());
+    args.insert(args.end(), {"-c", ckpt.string(), "-o", rwc.string(), (dir / "robots").string()});
+
+    pid_t pid = start(args, log);
+    bool running = true;
+    while (size_of(rwc) == 0) {
+        int status = 0;
+        if (waitpid(pid, &status, WNOHANG) == pid) { running = false; break; }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    if (running) {
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+    }
+    check(running, "the run was killed partway through");
+
+    if (loseResults) {
+        uintmax_t bytes = size_of(rwc);
+        std::error_code ec;
+        check(vouch_for(ckpt, bytes), "the checkpoint vouches for all " + std::to_string(bytes) + " results bytes");
+        fs::resize_file(rwc, bytes / 2, ec);
+        check(!ec, "the results file is cut to " + std::to_string(bytes / 2) + " bytes");
+    }
+
+    bool resumed = finish(start(args, log));
+    check(resumed, "the same command resumes and finishes");
+    check(read_text(log).find("resuming after") != std::string::npos, "it resumed from the checkpoint");
+    if (loseResults) {
+        check(read_text(log).find("rewriting this tournament's matches") != std::string::npos,
+              "it noticed the lost results and rewrote them");
+    }
+
+    std::vector<std::string> got = matches_in(rwc);
+    check(got.size() == reference.size(), std::to_string(got.size()) + " matches recorded, " +
+                                          std::to_string(reference.size()) + " expected");
+    check(got == reference, "every match matches the uninterrupted run's");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int matches = 6000; // room to kill a run between its first results block and the end
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) matches = std::max(5000, std::atoi(argv[++i]));
+        else {
+            std::cerr << "Usage: " << argv[0] << " [-n matches]\n";
+            return 2;
+        }
+    }
+
+    fs::path dir = fs::temp_directory_path() / ("robotwarz-resume-check-" + std::to_string(getpid()));
+    fs::create_directories(dir / "robots");
+    for (const auto& p : fs::directory_iterator(".")) {
+        std::string name = p.path().filename().string();
+        if (name.rfind("Robot_", 0) != 0 || p.path().extension() != ".cpp" || name == "Robot_Flame_e_o.cpp") continue;
+        fs::copy_file(p.path(), dir / "robots" / name);
+    }
+
+    std::vector<std::string> common{"-n", std::to_string(matches), "-s", "5", "-q", "20", "--uniform"};
+
+    // The uninterrupted run everything is compared with
+    std::cout << "reference, " << matches << " matches\n";
+    std::vector<std::string> args = common;
+    args.insert(args.end(), {"-t", "1", "-o", (dir / "reference.rwc").string(), (dir / "robots").string()});
+    check(finish(start(args, dir / "reference.log")), "the uninterrupted run finishes");
+    std::vector<std::string> reference = matches_in(dir / "reference.rwc");
+    check(reference.size() == static_cast<size_t>(matches), std::to_string(reference.size()) + " matches recorded");
+
+    check_mode("thread", {"-t", "2"}, common, dir, reference);
+    check_mode("fork", {"-t", "2", "-f", "50"}, common, dir, reference);
+    check_mode("lost", {"-t", "2"}, common, dir, reference, true);
+
+    fs::remove_all(dir);
+    if (failures) {
+        std::cout << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "all resume checks passed\n";
+    return 0;
+}
@@ -0,0 +1,367 @@
+#include "RobotLibraryPool.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <limits>
+#include <filesystem>
+#include <cstdlib>
+
+#include "RobotHeap.h"
+#include "ThreadCpuClock.h"
+
+// Conformance harness: hammers every robot with generated radar input on
+// random board sizes and checks what the arena relies on - radar and move
+// directions 0-8, shots inside the board, non-negative move distances, no
+// exceptions and every call finishing inside the time budget. Calls are timed
+// on the thread's CPU clock like the arena's budgets, so running more threads
+// than cores does not turn preemption into over-budget calls. Shots must also
+// land near a robot the radar reported in the last few turns, which catches
+// robots that clamp or aim with a hard-coded board size. Robots with a
+// robot_turn_v2 entry point are driven through it, the way the arena does.
+// Every instance allocates from its own RobotHeap like in the arena; the
+// report gives the most heap one instance held, and with -m a heap budget
+// that a call running out of fails with std::bad_alloc (an exception).
+//
+// usage: robot_conformance [-n turns] [-t threads] [-b budget_us] [-m heap_kb] [Robot_X.cpp ...]
+// Without sources every Robot_*.cpp in the current directory is checked.
+
+namespace {
+
+enum EntryPoint { radar_dir, process_radar, shot_location, move_direction, turn_v2, entry_count };
+const char* entry_names[entry_count] = {
+    "get_radar_direction", "process_radar_results", "get_shot_location", "get_move_direction", "robot_turn_v2"
+};
+
+struct Options {
+    long long turns = 1000000;  // per robot, split across threads
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    long long budget_us = 1000;
+    long long heap_kb = 0;      // 0 = no heap budget
+    int turns_per_instance = 200;
+    int min_size = 10;
+    int max_size = 500;
+    int aim_slack = 2;      // cells a shot may lead an observed robot by
+    int aim_memory = 8;     // turns a sighting stays a valid target
+};
+
+struct EntryStats {
+    long long calls = 0;
+    long long total_ns = 0;
+    long long worst_ns = 0;
+    long long over_budget = 0;
+};
+
+struct Report {
+    EntryStats entry[entry_count];
+    long long violations = 0;
+    long long exceptions = 0;
+    size_t heap_peak = 0;   // bytes, the most any one instance held
+    std::vector<std::string> examples;
+
+    void fail(const std::string& what) {
+        ++violations;
+        if (examples.size() < 5) examples.push_back(what);
+    }
+
+    void merge(const Report& o) {
+        for (int i = 0; i < entry_count; ++i) {
+            entry[i].calls += o.entry[i].calls;
+            entry[i].total_ns += o.entry[i].total_ns;
+            entry[i].worst_ns = std::max(entry[i].worst_ns, o.entry[i].worst_ns);
+            entry[i].over_budget += o.entry[i].over_budget;
+        }
+        violations += o.violations;
+        exceptions += o.exceptions;
+        heap_peak = std::max(heap_peak, o.heap_peak);
+        for (const auto& ex : o.examples) {
+            if (examples.size() < 5) examples.push_back(ex);
+        }
+    }
+};
+
+// What reading the thread CPU clock twice costs by itself (a system call,
+// unlike steady_clock); taken off every measurement so cheap calls are not
+// reported as a few hundred ns
+long long clock_overhead_ns() {
+    static const long long overhead = [] {
+        long long best = std::numeric_limits<long long>::max();
+        for (int i = 0; i < 1000; ++i) {
+            long long t0 = ThreadCpuClock::now_ns();
+            best = std::min(best, ThreadCpuClock::now_ns() - t0);
+        }
+        return best;
+    }();
+    return overhead;
+}
+
+// Times one robot call in thread CPU time, with its allocations in the
+// instance's heap, and turns an escaping exception into a violation
+template <typename Fn>
+bool timed_call(Report& rep, RobotHeap& heap, EntryPoint ep, long long budget_ns, Fn&& fn) {
+    long long t0 = ThreadCpuClock::now_ns();
+    bool ok = true;
+    try {
+        // the scope ends before a handler runs, so the report's strings
+        // are not allocated in a heap that goes away with the instance
+        RobotHeap::Scope scope(&heap);
+        fn();
+    } catch (const std::exception& ex) {
+        ++rep.exceptions;
+        rep.fail(std::string(entry_names[ep]) + " threw: " + ex.what());
+        ok = false;
+    } catch (...) {
+        ++rep.exceptions;
+        rep.fail(std::string(entry_names[ep]) + " threw a non-std exception");
+        ok = false;
+    }
+    long long ns = std::max(0LL, ThreadCpuClock::now_ns() - t0 - clock_overhead_ns());
+
+    EntryStats& st = rep.entry[ep];
+    ++st.calls;
+    st.total_ns += ns;
+    st.worst_ns = std::max(st.worst_ns, ns);
+    if (ns > budget_ns) ++st.over_budget;
+    return ok;
+}
+
+std::string at_board(int rows, int cols, int r, int c) {
+    return " on a " + std::to_string(rows) + "x" + std::to_string(cols) +
+           " board at (" + std::to_string(r) + "," + std::to_string(c) + ")";
+}
+
+// Radar results shaped like the arena's: cells along the requested ray,
+// 3 wide, excluding the robot's own cell, about one cell in ten occupied
+void generate_radar(std::mt19937& rng, int rows, int cols, int r0, int c0, int dir,
+                    std::vector<RadarObj>& out) {
+    static const char kinds[] = { 'R', 'X', 'M', 'F', 'P' };
+    std::uniform_int_distribution<int> kind(0, sizeof(kinds) - 1);
+    out.clear();
+
+    auto add = [&](int r, int c) {
+        if (r < 0 || r >= rows || c < 0 || c >= cols || (r == r0 && c == c0)) return;
+        if (rng() % 10 != 0) return;
+        out.emplace_back(kinds[kind(rng)], r, c);
+    };
+
+    if (dir < 1 || dir > 8) {
+        for (int dr = -1; dr <= 1; ++dr)
+            for (int dc = -1; dc <= 1; ++dc) add(r0 + dr, c0 + dc);
+        return;
+    }
+
+    auto d = directions[dir];
+    int pr = -d.second, pc = d.first;
+    for (int r = r0 + d.first, c = c0 + d.second;
+         r >= 0 && r < rows && c >= 0 && c < cols; r += d.first, c += d.second) {
+        for (int w = -1; w <= 1; ++w) add(r + pr * w, c + pc * w);
+    }
+}
+
+void fuzz_robot(RobotFactory factory, RobotTurnV2 turn, const Options& opt, long long turns, unsigned seed, Report& rep) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> size(opt.min_size, opt.max_size);
+    const long long budget_ns = opt.budget_us * 1000;
+    std::vector<RadarObj> radar;
+    std::vector<std::vector<RadarObj>> sightings(opt.aim_memory);
+
+    auto aimed = [&](int sr, int sc) {
+        for (const auto& past : sightings)
+            for (const auto& obj : past)
+                if (std::abs(obj.m_row - sr) <= opt.aim_slack && std::abs(obj.m_col - sc) <= opt.aim_slack) return true;
+        return false;
+    };
+
+    long long done = 0;
+    while (done < turns) {
+        int rows = size(rng), cols = size(rng);
+        RobotHeap::Ptr heap = RobotHeap::make();
+        std::unique_ptr<RobotBase> robot;
+        {
+            RobotHeap::Scope scope(heap.get());
+            robot.reset(factory());
+        }
+        if (!robot) { rep.fail("create_robot returned null"); return; }
+        heap->set_limit(static_cast<size_t>(opt.heap_kb) * 1024);
+
+        robot->set_boundaries(rows, cols);
+        int row = std::uniform_int_distribution<int>(0, rows - 1)(rng);
+        int col = std::uniform_int_distribution<int>(0, cols - 1)(rng);
+        robot->move_to(row, col);
+        for (auto& past : sightings) past.clear();
+        int nextDir = 0;
+
+        for (int t = 0; t < opt.turns_per_instance && done < turns; ++t, ++done) {
+            // occasionally exercise damage and pit handling like the arena would
+            if (rng() % 16 == 0) robot->take_damage(5);
+            if (rng() % 64 == 0) robot->reduce_armor(1);
+            if (rng() % 256 == 0) robot->disable_movement();
+            if (robot->get_health() <= 0) break;
+
+            int sr = 0, sc = 0, md = 0, dist = 0;
+            bool shoots = false;
+            auto& seen = sightings[t % opt.aim_memory];
+            auto note_sightings = [&] {
+                seen.clear();
+                for (const auto& obj : radar) if (obj.m_type == 'R') seen.push_back(obj);
+            };
+
+            if (turn) {
+                // v2: one call with the scan asked for last turn
+                generate_radar(rng, rows, cols, row, col, nextDir, radar);
+                note_sightings();
+                RobotAction a{};
+                if (!timed_call(rep, *heap, turn_v2, budget_ns, [&] { a = turn(robot.get(), radar.data(), radar.size()); })) break;
+                nextDir = a.radarDirection;
+                if (nextDir < 0 || nextDir > 8) {
+                    rep.fail("radar direction " + std::to_string(nextDir) + at_board(rows, cols, row, col));
+                    nextDir = 0;
+                }
+                if (a.kind == robot_action_shoot) {
+                    shoots = true;
+                    sr = a.a;
+                    sc = a.b;
+                } else if (a.kind == robot_action_move) {
+                    md = a.a;
+                    dist = a.b;
+                } else if (a.kind != robot_action_none) {
+                    rep.fail("action kind " + std::to_string(a.kind) + at_board(rows, cols, row, col));
+                    continue;
+                }
+            } else {
+                int dir = 0;
+                if (!timed_call(rep, *heap, radar_dir, budget_ns, [&] { robot->get_radar_direction(dir); })) break;
+                if (dir < 0 || dir > 8) {
+                    rep.fail("radar direction " + std::to_string(dir) + at_board(rows, cols, row, col));
+                    dir = 0;
+                }
+
+                generate_radar(rng, rows, cols, row, col, dir, radar);
+                if (!timed_call(rep, *heap, process_radar, budget_ns, [&] { robot->process_radar_results(radar); })) break;
+                note_sightings();
+
+                if (!timed_call(rep, *heap, shot_location, budget_ns, [&] { shoots = robot->get_shot_location(sr, sc); })) break;
+                if (!shoots && !timed_call(rep, *heap, move_direction, budget_ns, [&] { robot->get_move_direction(md, dist); })) break;
+            }
+
+            if (shoots) {
+                if (sr < 0 || sr >= rows || sc < 0 || sc >= cols) {
+                    rep.fail("shot at (" + std::to_string(sr) + "," + std::to_string(sc) + ")" +
+                             at_board(rows, cols, row, col));
+                } else if (!aimed(sr, sc)) {
+                    rep.fail("shot at (" + std::to_string(sr) + "," + std::to_string(sc) +
+                             ") with no robot seen near it" + at_board(rows, cols, row, col));
+                }
+                continue;
+            }
+
+            if (md < 0 || md > 8 || dist < 0) {
+                rep.fail("move direction " + std::to_string(md) + " distance " + std::to_string(dist) +
+                         at_board(rows, cols, row, col));
+                continue;
+            }
+
+            // Apply the move the way the arena does, clipped at the real edge
+            dist = std::min(dist, robot->get_move_speed());
+            for (int s = 0; s < dist && md != 0; ++s) {
+                int nr = row + directions[md].first, nc = col + directions[md].second;
+                if (nr < 0 || nr >= rows || nc < 0 || nc >= cols) break;
+                row = nr; col = nc;
+            }
+            robot->move_to(row, col);
+        }
+        rep.heap_peak = std::max(rep.heap_peak, heap->peak_bytes());
+    }
+}
+
+bool check_robot(const RobotFactoryEntry& robot, const Options& opt) {
+    std::vector<Report> reports(opt.threads);
+    std::vector<std::thread> workers;
+    long long per_thread = (opt.turns + opt.threads - 1) / opt.threads;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < opt.threads; ++i) {
+        workers.emplace_back(fuzz_robot, robot.factory, robot.turn, std::cref(opt), per_thread, 1234u + i, std::ref(reports[i]));
+    }
+    for (auto& w : workers) w.join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    Report total;
+    for (const auto& r : reports) total.merge(r);
+
+    long long calls = 0;
+    for (const auto& st : total.entry) calls += st.calls;
+
+    std::cout << "\n" << robot.name << ": " << calls << " calls in " << std::fixed << std::setprecision(2)
+              << secs << "s (" << static_cast<long long>(calls / std::max(secs, 1e-9)) << " calls/s)\n";
+    for (int i = 0; i < entry_count; ++i) {
+        const auto& st = total.entry[i];
+        if (st.calls == 0) continue;
+        double avg = st.calls ? static_cast<double>(st.total_ns) / st.calls : 0.0;
+        std::cout << "  " << std::left << std::setw(24) << entry_names[i] << std::right
+                  << std::setw(10) << st.calls << " calls"
+                  << "  avg " << std::setw(8) << std::setprecision(0) << avg << " ns"
+                  << "  worst " << std::setw(8) << std::setprecision(1) << st.worst_ns / 1000.0 << " us"
+                  << "  over budget " << st.over_budget << "\n";
+    }
+
+    std::cout << "  heap peak: " << std::setprecision(1) << total.heap_peak / 1024.0 << " KB";
+    if (opt.heap_kb > 0) std::cout << " of " << opt.heap_kb << " KB";
+    std::cout << "\n";
+
+    long long over = 0;
+    for (const auto& st : total.entry) over += st.over_budget;
+
+    bool pass = total.violations == 0 && over == 0;
+    std::cout << "  violations: " << total.violations << " (exceptions: " << total.exceptions << ")\n";
+    for (const auto& ex : total.examples) std::cout << "    " << ex << "\n";
+    std::cout << "  " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    std::vector<std::string> sources;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) opt.turns = std::stoll(argv[++i]);
+        else if (arg == "-t" && i + 1 < argc) opt.threads = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "-b" && i + 1 < argc) opt.budget_us = std::stoll(argv[++i]);
+        else if (arg == "-m" && i + 1 < argc) opt.heap_kb = std::stoll(argv[++i]);
+        else if (arg.rfind("-", 0) == 0) {
+            std::cerr << "Usage: " << argv[0] << " [-n turns] [-t threads] [-b budget_us] [-m heap_kb] [Robot_X.cpp ...]\n";
+            return 1;
+        } else sources.push_back(arg);
+    }
+
+    RobotLibraryPool pool;
+    if (sources.empty()) {
+        pool.load_directory(".");
+    } else {
+        for (const auto& src : sources) pool.load_source(src);
+    }
+    if (pool.factories().empty()) {
+        std::cerr << "No robots to check\n";
+        return 1;
+    }
+
+    std::cout << "Checking " << pool.factories().size() << " robot(s): " << opt.turns << " turns each on "
+              << opt.threads << " thread(s), boards " << opt.min_size << ".." << opt.max_size
+              << ", budget " << opt.budget_us << " us per call\n";
+
+    int failed = 0;
+    for (const auto& robot : pool.factories()) {
+        if (!check_robot(robot, opt)) ++failed;
+    }
+
+    std::cout << "\n" << pool.factories().size() - failed << " passed, " << failed << " failed\n";
+    return failed == 0 ? 0 : 1;
+}
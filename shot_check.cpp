@@ -0,0 +1,135 @@
+#include "Arena.h"
+#include "GameMap.h"
+#include <iostream>
+#include <sstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <utility>
+#include <unistd.h>
+
+// Plays one round of spec rules on small fixed maps and checks who a shot
+// damaged:
+//   hammer    a hammer swung at an adjacent enemy hurts it and not the
+//             shooter; swung at an enemy two cells away it is out of range
+//   grenade   a grenade aimed at an adjacent enemy has the shooter inside its
+//             3x3 block, and still only hurts the enemy
+// The shooter aims at the map's other spawn point; the target never shoots
+// or moves. Both robots are defined here, so no robot libraries are built.
+//
+// usage: shot_check
+
+namespace {
+
+namespace fs = std::filesystem;
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "  ok    " : "  FAIL  ") << what << "\n";
+    if (!ok) ++failures;
+}
+
+// spawn points of the map being played, for the shooter to aim with
+std::vector<std::pair<int,int>> spawns;
+
+template <WeaponType Weapon>
+class Shooter : public RobotBase {
+public:
+    Shooter() : RobotBase(2, 5, Weapon) { m_name = "Shooter"; }
+    void get_radar_direction(int& radar_direction) override { radar_direction = 0; }
+    void process_radar_results(const std::vector<RadarObj>&) override {}
+    bool get_shot_location(int& shot_row, int& shot_col) override {
+        int row, col;
+        get_current_location(row, col);
+        for (auto [r, c] : spawns) {
+            if (r != row || c != col) { shot_row = r; shot_col = c; return true; }
+        }
+        return false;
+    }
+    void get_move_direction(int& direction, int& distance) override { direction = 1; distance = 0; }
+};
+
+class Target : public RobotBase {
+public:
+    Target() : RobotBase(2, 5, railgun) { m_name = "Target"; }
+    void get_radar_direction(int& radar_direction) override { radar_direction = 0; }
+    void process_radar_results(const std::vector<RadarObj>&) override {}
+    bool get_shot_location(int&, int&) override { return false; }
+    void get_move_direction(int& direction, int& distance) override { direction = 1; distance = 0; }
+};
+
+template <typename T>
+RobotBase* create() { return new T(); }
+
+// One round on board (printed the way map_convert reads it); damage taken by
+// the shooter and by the target
+std::pair<int,int> play_round(const std::string& board, RobotFactory shooter, const fs::path& dir) {
+    std::istringstream in(board);
+    auto map = GameMap::parse_ascii(in);
+    // maps are cached by path, so each board gets its own file
+    static int maps = 0;
+    fs::path path = dir / ("map" + std::to_string(maps++) + ".rwm");
+    if (!map || !map->save(path.string())) return {-1, -1};
+    spawns = map->spawns();
+
+    GameConfig cfg;
+    cfg.liveView = false;
+    cfg.quiet = true;
+    cfg.maxRounds = 1;
+    cfg.mapPath = path.string();
+    cfg.rules = spec_rules;
+    std::vector<RobotFactoryEntry> roster(2);
+    roster[0].name = "Shooter";
+    roster[0].factory = shooter;
+    roster[1].name = "Target";
+    roster[1].factory = create<Target>;
+    Arena arena(cfg);
+    if (!arena.load_robots(roster)) return {-1, -1};
+    MatchResult res = arena.run();
+    return {res.damageTaken[0], res.damageTaken[1]};
+}
+
+void check_hammer(const fs::path& dir) {
+    std::cout << "hammer\n";
+    auto [shooter, target] = play_round("   0 1 2\n"
+                                        "0  . . .\n"
+                                        "1  . R R\n"
+                                        "2  . . .\n", create<Shooter<hammer>>, dir);
+    check(target > 0, "an adjacent enemy takes " + std::to_string(target) + " damage");
+    check(shooter == 0, "the shooter takes " + std::to_string(shooter) + " damage");
+
+    std::tie(shooter, target) = play_round("   0 1 2 3\n"
+                                           "0  . . . .\n"
+                                           "1  . R . R\n"
+                                           "2  . . . .\n", create<Shooter<hammer>>, dir);
+    check(target == 0 && shooter == 0, "an enemy two cells away is out of range");
+}
+
+void check_grenade(const fs::path& dir) {
+    std::cout << "grenade\n";
+    auto [shooter, target] = play_round("   0 1 2\n"
+                                        "0  . . .\n"
+                                        "1  . R R\n"
+                                        "2  . . .\n", create<Shooter<grenade>>, dir);
+    check(target > 0, "an adjacent enemy takes " + std::to_string(target) + " damage");
+    check(shooter == 0, "the shooter inside the blast takes " + std::to_string(shooter) + " damage");
+}
+
+} // namespace
+
+int main() {
+    fs::path dir = fs::temp_directory_path() / ("robotwarz-shot-check-" + std::to_string(getpid()));
+    fs::create_directories(dir);
+
+    check_hammer(dir);
+    check_grenade(dir);
+
+    fs::remove_all(dir);
+    if (failures) {
+        std::cout << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "all shot checks passed\n";
+    return 0;
+}
@@ -156,7 +156,8 @@ int main(int argc, char* argv[])
 
     // Compile the robot into a shared library -fPIC is Position Independant Code - look it up!
     // we're also linking a pre-compiled RobotBase.o - problems will arise if there is a mismatch...
-    std::string compile_cmd = "g++ -shared -fPIC -o " + shared_lib + " " + robot_file + " RobotBase.o -I. -std=c++20";
+    // OccupancyMap.o and PathPlanner.o are the optional robot-side helper libraries
+    std::string compile_cmd = "g++ -shared -fPIC -o " + shared_lib + " " + robot_file + " RobotBase.o OccupancyMap.o PathPlanner.o -I. -std=c++20";
     std::cout << "Compiling " << robot_file << " into " << shared_lib << "...\n";
 
     if (std::system(compile_cmd.c_str()) != 0) {
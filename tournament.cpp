@@ -0,0 +1,97 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+
+#include "Tournament.h"
+#include "RobotLibraryPool.h"
+
+// Rates robots by playing many quiet matches between them.
+//
+// usage: tournament [-n matches] [-k robots per match] [-t threads] [-s seed]
+//                   [-r ratings.bin] [-o results.rwc] [-q quiet rounds]
+//                   [-m map.rwm] [-R rules] [-c checkpoint] [-M heap kb]
+//                   [-f batch] [-D seconds] [--uniform] [robots dir]
+// Ratings are loaded from and saved back to the -r file when given; -o
+// appends every match to a results file for results_query. Matches stop
+// early on a stalemate after -q rounds without damage (default 20, 0 = off).
+// -m plays every match on the same fixed map; -R picks a built-in rule set
+// (spec or legacy, see Rules.h). -c logs every finished match to a checkpoint
+// file; rerunning the same command after a crash resumes from it, and once
+// the tournament has finished it does nothing (so -r is not counted twice).
+// -M caps the heap each robot may hold; with -o every robot's peak heap is
+// stored next to its CPU time.
+// -f plays the matches in forked worker processes, batch matches each and -t
+// of them at a time, so a robot that crashes costs only its worker's batch.
+// -D is the wall-clock time a forked worker gets per match of its batch
+// (default 10, 0 = no limit); a worker still running past it is killed, so a
+// robot stuck in a loop costs the match it hung in.
+// --uniform picks random pairings instead of adaptive ones, for comparison.
+int main(int argc, char* argv[]) {
+    TournamentConfig cfg;
+    cfg.game.maxRounds = 100;
+    cfg.game.stalemateRounds = 20;
+    std::string robotsDir = ".";
+    std::string ratingsPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) cfg.matches = std::atoi(argv[++i]);
+        else if (arg == "-k" && i + 1 < argc) cfg.robotsPerMatch = std::max(2, std::atoi(argv[++i]));
+        else if (arg == "-t" && i + 1 < argc) cfg.threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "-s" && i + 1 < argc) cfg.seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "-r" && i + 1 < argc) ratingsPath = argv[++i];
+        else if (arg == "-o" && i + 1 < argc) cfg.resultsPath = argv[++i];
+        else if (arg == "-q" && i + 1 < argc) cfg.game.stalemateRounds = std::atoi(argv[++i]);
+        else if (arg == "-m" && i + 1 < argc) cfg.game.mapPath = argv[++i];
+        else if (arg == "-c" && i + 1 < argc) cfg.checkpointPath = argv[++i];
+        else if (arg == "-M" && i + 1 < argc) cfg.game.memoryBudgetKb = std::atoll(argv[++i]);
+        else if (arg == "-f" && i + 1 < argc) cfg.forkBatch = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "-D" && i + 1 < argc) cfg.matchSeconds = std::max(0.0, std::atof(argv[++i]));
+        else if (arg == "-R" && i + 1 < argc) {
+            const Rules* rules = find_rules(argv[++i]);
+            if (!rules) {
+                std::cerr << "Unknown rules " << argv[i] << "\n";
+                return 1;
+            }
+            cfg.game.rules = *rules;
+        }
+        else if (arg == "--uniform") cfg.adaptive = false;
+        else if (arg.rfind("-", 0) == 0) {
+            std::cerr << "Usage: " << argv[0] << " [-n matches] [-k robots per match] [-t threads] [-s seed]"
+                      << " [-r ratings.bin] [-o results.rwc] [-q quiet rounds] [-m map.rwm] [-R rules] [-c checkpoint] [-M heap kb] [-f batch] [-D seconds] [--uniform] [robots dir]\n";
+            return 1;
+        } else robotsDir = arg;
+    }
+
+    RobotLibraryPool& pool = RobotLibraryPool::shared();
+    if (!pool.load_directory(robotsDir) || pool.factories().empty()) {
+        std::cerr << "No robots loaded from: " << robotsDir << "\n";
+        return 1;
+    }
+
+    if (!cfg.game.mapPath.empty() && !GameMap::shared(cfg.game.mapPath)) return 1;
+
+    RatingTable ratings;
+    if (!ratingsPath.empty()) ratings.load(ratingsPath);
+
+    auto t0 = std::chrono::steady_clock::now();
+    Tournament tournament(pool.factories(), cfg, ratings);
+    int played = tournament.run();
+    if (tournament.already_finished()) return 0;
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::cout << played << " matches in " << std::fixed << std::setprecision(2) << secs << "s, "
+              << std::setprecision(1) << static_cast<double>(tournament.rounds_played()) / std::max(1, played)
+              << " rounds on average, " << tournament.stalemates() << " stopped on a stalemate\n\n";
+    for (const auto& s : ratings.standings()) {
+        std::cout << std::left << std::setw(20) << s.name << std::right
+                  << std::setw(8) << std::setprecision(1) << s.rating
+                  << std::setw(8) << s.games << " games\n";
+    }
+
+    if (!ratingsPath.empty() && !ratings.save(ratingsPath)) return 1;
+    return 0;
+}